@@ -0,0 +1,128 @@
+// AsyncHttpClient.h
+
+#ifndef ASYNCHTTPCLIENT_H
+#define ASYNCHTTPCLIENT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <httplib.h>
+#include "GzipDecoder.h"
+#include "HostResolver.h"
+
+// Completion callback for asynchronous requests; res is nullptr when the request failed
+// before a complete response was received (connect error, reset, timeout).
+typedef std::function<void(const httplib::Response* res)> AsyncCallback;
+
+// Observer for the body size of each completed response, before and after decoding.
+typedef std::function<void(size_t wireBytes, size_t decodedBytes)> TransferObserver;
+
+// Picks where a response's decoded body goes once its headers are in; an empty sink keeps
+// the body in Response::body. A sink that returns false fails the request.
+typedef std::function<DecodedSink(const httplib::Response& head)> BodyReceiver;
+
+// HTTP Response Parser: Incremental HTTP/1.1 response parser. Bytes can be fed in pieces of
+// any size as they arrive from the socket; supports Content-Length, chunked and
+// close-delimited bodies. gzip/deflate bodies are inflated as they stream in, and are handed
+// to the body receiver's sink instead of being buffered when it provides one.
+class HttpResponseParser {
+public:
+    HttpResponseParser();
+
+    void reset(); // Also drops the body receiver
+    void setReceiver(BodyReceiver receiver) { receiver_ = std::move(receiver); }
+    size_t feed(const char* data, size_t size);
+    bool finishOnEof(); // Completes a close-delimited body; false if the response was cut short
+
+    bool complete() const { return state_ == Complete; }
+    bool failed() const { return state_ == Error; }
+    bool started() const { return started_; }
+    bool keepAlive() const { return keepAlive_; }
+    size_t wireBodyBytes() const { return wireBodyBytes_; }
+    size_t decodedBodyBytes() const { return decodedBodyBytes_; }
+    httplib::Response& response() { return response_; }
+
+private:
+    enum State { StatusLine, Headers, Body, ChunkSize, ChunkData, ChunkDataEnd, Trailers, Complete, Error };
+
+    void processLine(const std::string& line);
+    void beginBody();
+    void appendBody(const char* data, size_t size);
+
+    State state_;
+    httplib::Response response_;
+    std::string line_;
+    size_t remaining_;
+    size_t wireBodyBytes_;
+    size_t decodedBodyBytes_;
+    std::unique_ptr<GzipDecoder> decoder_;
+    BodyReceiver receiver_;
+    DecodedSink sink_;
+    bool untilClose_;
+    bool keepAlive_;
+    bool started_;
+};
+
+// Async Transports: Epoll waits for socket readiness and then issues send/recv calls;
+// IoUring queues connect/send/recv operations and submits them to the kernel in batches.
+enum class AsyncTransport { Epoll, IoUring };
+
+// Async HTTP Client: Non-blocking HTTP/1.1 GET engine. A few event-loop threads multiplex
+// many in-flight requests over keep-alive sockets to one host, so the number of concurrent
+// requests is bounded by maxConnections rather than by thread count. Only available on
+// Linux; elsewhere supported() is false and every request fails. An io_uring client falls
+// back to epoll when liburing was not found at build time or the kernel lacks support.
+// With a resolver, new connections go to its cached address for the host, so a lookup runs
+// only when the entry's time to live has run out or a connect to the address failed.
+class AsyncHttpClient {
+public:
+    AsyncHttpClient(const std::string& schemeHostPort, AsyncTransport transport = AsyncTransport::Epoll,
+        size_t loopThreads = 1, size_t maxConnections = 512, HostResolver* resolver = nullptr);
+    ~AsyncHttpClient();
+
+    static bool supported(AsyncTransport transport = AsyncTransport::Epoll);
+    AsyncTransport transport() const { return transport_; }
+
+    // A timeout of 0 uses the client-wide request timeout. The timeout runs from this call, so
+    // time spent waiting for a free connection counts against it.
+    void get(const std::string& path, const httplib::Headers& headers, AsyncCallback callback,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(0), BodyReceiver receiver = BodyReceiver());
+    void waitIdle();
+    void shutdown(); // Must not race with get()
+
+    void setRequestTimeout(std::chrono::milliseconds timeout) { requestTimeoutMs_ = timeout.count(); }
+    void setTransferObserver(TransferObserver observer) { transferObserver_ = observer; } // Set before the first get()
+    size_t inFlight() const { return inFlight_; }
+
+private:
+    struct Loop;
+    struct EpollLoop;
+    struct UringLoop;
+
+    AsyncHttpClient(const AsyncHttpClient&) = delete;
+    AsyncHttpClient& operator=(const AsyncHttpClient&) = delete;
+
+    void finishRequest();
+
+    std::string host_;
+    int port_;
+    HostResolver* resolver_;
+    AsyncTransport transport_;
+    std::vector<std::unique_ptr<Loop>> loops_;
+    std::atomic<size_t> nextLoop_;
+    std::atomic<size_t> inFlight_;
+    std::atomic<long long> requestTimeoutMs_;
+    TransferObserver transferObserver_;
+    std::mutex idleMutex_;
+    std::condition_variable idle_;
+    std::atomic<bool> stopped_;
+};
+
+#endif // ASYNCHTTPCLIENT_H
@@ -0,0 +1,37 @@
+// CancellationToken.h
+
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Cancellation Token: Copyable handle to a shared flag that queued work polls before it
+// starts. A token is cancelled through cancel() on any copy, or as soon as its optional
+// condition returns true. A default-constructed token without a condition only ends up
+// cancelled if cancel() is called.
+class CancellationToken {
+public:
+    CancellationToken() : state_(std::make_shared<State>()) {}
+    explicit CancellationToken(std::function<bool()> condition) : state_(std::make_shared<State>()) {
+        state_->condition = std::move(condition);
+    }
+
+    void cancel() { state_->cancelled = true; }
+    bool cancelled() const {
+        return state_->cancelled || (state_->condition && state_->condition());
+    }
+
+private:
+    struct State {
+        State() : cancelled(false) {}
+
+        std::atomic<bool> cancelled;
+        std::function<bool()> condition;
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -0,0 +1,97 @@
+// CircuitBreaker.h
+
+#ifndef CIRCUITBREAKER_H
+#define CIRCUITBREAKER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Breaker Options: When a circuit breaker trips and how it recovers.
+struct BreakerOptions {
+    size_t window;                          // Most recent calls the failure rate is taken over
+    size_t minimumCalls;                    // Calls in the window before the breaker may trip
+    double failureRatio;                    // Share of failed calls in the window that trips it
+    std::chrono::milliseconds slowCall;     // Calls slower than this count as failures
+    std::chrono::milliseconds openDuration; // Time spent open before probing the upstream again
+    int halfOpenProbes;                     // Trial calls let through; all must succeed to close
+};
+
+enum class BreakerState { Closed, Open, HalfOpen };
+
+// Circuit Breaker: Watches the outcome and latency of calls to one upstream endpoint. While
+// closed every call goes through; once too many recent calls failed or were slow it opens and
+// calls are refused without touching the network. After openDuration it goes half-open and
+// lets a few probes through: if they all succeed it closes, if any fails it opens again.
+class CircuitBreaker {
+public:
+    // One state change, kept for the metrics panel.
+    struct Transition {
+        BreakerState from;
+        BreakerState to;
+        std::chrono::system_clock::time_point at;
+        std::string reason;
+    };
+
+    // Snapshot of the breaker counters.
+    struct Stats {
+        BreakerState state;
+        uint64_t allowed;     // Calls let through
+        uint64_t rejected;    // Calls refused while open or while the probes were out
+        uint64_t failures;    // Calls recorded as failed, slow ones included
+        uint64_t slowCalls;
+        uint64_t opened;      // Times the breaker tripped
+        double failureRate;   // Over the current window
+    };
+
+    typedef std::function<void(const CircuitBreaker& breaker, const Transition& transition)> TransitionObserver;
+
+    CircuitBreaker(const std::string& name, const BreakerOptions& options,
+        TransitionObserver observer = TransitionObserver());
+
+    bool allow();           // false means fail fast; true must be followed by record() or abandon()
+    bool isOpen() const;    // Open and not yet due for a probe: every call is refused
+    void record(bool success, double latencyMs);
+    void abandon();         // A call allow() let through never reached the upstream
+
+    const std::string& name() const { return name_; }
+    BreakerState state() const;
+    Stats stats() const;
+    std::vector<Transition> transitions() const; // Most recent last
+
+    static const char* stateName(BreakerState state);
+
+private:
+    CircuitBreaker(const CircuitBreaker&) = delete;
+    CircuitBreaker& operator=(const CircuitBreaker&) = delete;
+
+    void transitionLocked(BreakerState to, const std::string& reason, std::vector<Transition>& fired);
+    void notify(const std::vector<Transition>& fired) const;
+    bool rejectingLocked(std::chrono::steady_clock::time_point now) const;
+
+    const std::string name_;
+    const BreakerOptions options_;
+
+    mutable std::mutex mutex_;
+    BreakerState state_;
+    std::deque<bool> outcomes_; // true for a failed call, oldest first
+    size_t windowFailures_;
+    std::chrono::steady_clock::time_point openedAt_;
+    int probesSent_;
+    int probesSucceeded_;
+    std::deque<Transition> transitions_;
+    const TransitionObserver observer_;
+
+    uint64_t allowed_;
+    uint64_t rejected_;
+    uint64_t failures_;
+    uint64_t slowCalls_;
+    uint64_t opened_;
+};
+
+#endif // CIRCUITBREAKER_H
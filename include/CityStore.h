@@ -0,0 +1,244 @@
+// CityStore.h
+
+#ifndef CITYSTORE_H
+#define CITYSTORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "RcuDomain.h"
+#include "WeatherFields.h"
+
+// Slot of a city in the CityStore. Only meaningful on the UI thread, and only until the city
+// is removed; anything that outlives a frame or crosses threads holds a CityHandle instead.
+typedef size_t CityIndex;
+
+// City Handle: Names a city by slot and by the generation the slot had when the city was
+// added. Removing the city moves the slot to a new generation, so an old handle stops
+// resolving even after the slot is reused. A default handle names no city.
+struct CityHandle {
+    uint32_t slot;
+    uint32_t generation; // 0 in the null handle
+
+    CityHandle() : slot(0), generation(0) {}
+    CityHandle(uint32_t slot, uint32_t generation) : slot(slot), generation(generation) {}
+
+    bool valid() const { return generation != 0; }
+    bool operator==(const CityHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const CityHandle& other) const { return !(*this == other); }
+    bool operator<(const CityHandle& other) const { return slot != other.slot ? slot < other.slot : generation < other.generation; }
+};
+
+// Hashes a CityHandle, for unordered containers keyed by city.
+struct CityHandleHash {
+    size_t operator()(const CityHandle& city) const { return std::hash<uint64_t>()((uint64_t(city.generation) << 32) | city.slot); }
+};
+
+// Cache Validators: ETag and Last-Modified of the response that a city's weather was built
+// from, sent back as If-None-Match / If-Modified-Since so an unchanged location costs a 304.
+struct CacheValidators {
+    std::string etag;
+    std::string lastModified;
+
+    bool empty() const { return etag.empty() && lastModified.empty(); }
+};
+
+// City Column: One field of every city slot, allocated in fixed-size chunks that never move.
+// Growing only publishes new chunks, so other threads may keep reading and writing elements
+// of existing slots while the UI thread adds cities, without taking a lock.
+template <typename T>
+class CityColumn {
+public:
+    static const size_t kChunkBits = 12;
+    static const size_t kChunkSize = size_t(1) << kChunkBits;
+    static const size_t kMaxChunks = 256;
+    static const size_t kCapacity = kChunkSize * kMaxChunks;
+
+    CityColumn() {
+        for (auto& chunk : chunks_) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    ~CityColumn() { clear(); }
+
+    T& operator[](CityIndex i) { return chunks_[i >> kChunkBits].load(std::memory_order_acquire)[i & (kChunkSize - 1)]; }
+    const T& operator[](CityIndex i) const { return chunks_[i >> kChunkBits].load(std::memory_order_acquire)[i & (kChunkSize - 1)]; }
+
+    // Makes slots [0, size) addressable; new elements are value-initialized. Chunks are
+    // allocated in order, so the search stops at the first one that exists.
+    void reserve(size_t size) {
+        for (size_t c = (size + kChunkSize - 1) >> kChunkBits; c > 0; c--) {
+            if (chunks_[c - 1].load(std::memory_order_relaxed)) {
+                break;
+            }
+            chunks_[c - 1].store(new T[kChunkSize](), std::memory_order_release);
+        }
+    }
+
+    // Frees every chunk; only while no other thread can reach the column.
+    void clear() {
+        for (auto& chunk : chunks_) {
+            delete[] chunk.exchange(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    CityColumn(const CityColumn&) = delete;
+    CityColumn& operator=(const CityColumn&) = delete;
+
+    std::atomic<T*> chunks_[kMaxChunks];
+};
+
+// City Bitset: One bit per city, packed 64 to a word, so clearing, filling, counting and
+// listing the set bits touch size / 64 words instead of every city.
+class CityBitset {
+public:
+    CityBitset() : size_(0) {}
+
+    size_t size() const { return size_; }
+    void resize(size_t size); // Added bits start clear
+    bool test(CityIndex i) const { return (words_[i >> 6] >> (i & 63)) & 1; }
+    void set(CityIndex i, bool value);
+    void clear();
+    void fill();
+    size_t count() const;
+    bool any() const;
+    std::vector<CityIndex> indices() const; // Of the set bits, in order
+
+    // Calls f(index) for each set bit, in order.
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t w = 0; w < words_.size(); w++) {
+            for (uint64_t word = words_[w]; word != 0; word &= word - 1) {
+                f(w * 64 + lowestBit(word));
+            }
+        }
+    }
+
+private:
+    static size_t lowestBit(uint64_t word);
+
+    std::vector<uint64_t> words_;
+    size_t size_;
+};
+
+// Name Table: Stores each distinct name once and hands out a 32-bit id for it. Names are kept
+// in a deque, so a reference to one stays valid while others are added.
+class NameTable {
+public:
+    uint32_t intern(const std::string& name);
+    bool find(const std::string& name, uint32_t& id) const;
+    const std::string& name(uint32_t id) const { return names_[id]; }
+    size_t size() const { return names_.size(); }
+    void clear();
+
+private:
+    std::deque<std::string> names_;
+    std::unordered_map<std::string, uint32_t> ids_;
+};
+
+// City Store: The city list kept column by column, as a slot map. Each field of every city
+// lives in its own column (coordinates, selection and favorite bits, weather), so a scan over
+// one field reads only that field; names are interned and cities refer to them by id. Removed
+// cities leave their slot to be reused under a new generation.
+//
+// Cities are added, removed, listed and selected on the UI thread, by slot. Other threads hold
+// CityHandles: resolving one, and reading or writing the columns of the slot it resolves to,
+// needs no lock, because columns never move as the store grows. A city's weather is an
+// immutable snapshot published by pointer swap and reclaimed through rcu(), so it can be read
+// from any thread inside a ReadGuard without a lock. Weather, IDs and validators are only
+// written on the UI thread, where fetch results are applied.
+class CityStore {
+public:
+    static const CityIndex npos = static_cast<CityIndex>(-1);
+    static const size_t kCapacity = CityColumn<uint32_t>::kCapacity;
+
+    // A city of an initial list.
+    struct Entry {
+        std::string name;
+        double lon;
+        double lat;
+    };
+
+    CityStore() : slots_(0), liveCount_(0) {}
+    CityStore(std::initializer_list<Entry> entries);
+    ~CityStore();
+
+    size_t slots() const { return slots_.load(std::memory_order_acquire); } // Live and free slots
+    size_t size() const { return liveCount_; }                              // Live cities
+    bool alive(CityIndex i) const { return live_.test(i); }
+    const CityBitset& live() const { return live_; }
+
+    CityHandle add(const std::string& name, double lon, double lat); // Null handle when full
+    bool remove(CityHandle city);
+    void clear(); // Only while no other thread holds a handle; snapshots are retired through rcu()
+
+    CityHandle handle(CityIndex i) const { return CityHandle(static_cast<uint32_t>(i), generation_[i].load(std::memory_order_acquire)); }
+    bool resolve(CityHandle city, CityIndex& i) const;
+    bool contains(CityHandle city) const { CityIndex i; return resolve(city, i); }
+    CityIndex find(const std::string& name) const; // Oldest live city with the name, npos if none
+
+    const std::string& name(CityIndex i) const { return *name_[i]; }
+    double lon(CityIndex i) const { return lon_[i]; }
+    double lat(CityIndex i) const { return lat_[i]; }
+
+    bool selected(CityIndex i) const { return selected_.test(i); }
+    void setSelected(CityIndex i, bool value) { selected_.set(i, value); }
+    const CityBitset& selection() const { return selected_; }
+    void clearSelection() { selected_.clear(); }
+    void selectAll() { selected_ = live_; }
+
+    bool favorite(CityIndex i) const { return favorite_.test(i); }
+    void setFavorite(CityIndex i, bool value) { favorite_.set(i, value); }
+    const CityBitset& favorites() const { return favorite_; }
+
+    // Weather: weather() is nullptr for a city without any, and the snapshot it returns stays
+    // valid until the caller's RcuDomain::ReadGuard on rcu() ends.
+    RcuDomain& rcu() const { return rcu_; }
+    bool hasWeather(CityIndex i) const { return weather_[i].load(std::memory_order_relaxed) != nullptr; }
+    const WeatherSnapshot* weather(CityIndex i) const { return weather_[i].load(std::memory_order_seq_cst); }
+    void setWeather(CityIndex i, const WeatherSnapshot& weather); // Publishes a copy
+    void clearWeather(CityIndex i) { publish(i, nullptr); }
+
+    int owmId(CityIndex i) const { return owmId_[i]; } // 0 until resolved from a weather response
+    void setOwmId(CityIndex i, int id) { owmId_[i] = id; }
+    const CacheValidators& validators(CityIndex i) const { return validators_[i]; }
+    void setValidators(CityIndex i, const CacheValidators& validators) { validators_[i] = validators; }
+
+private:
+    CityStore(const CityStore&) = delete;
+    CityStore& operator=(const CityStore&) = delete;
+
+    void reserve(size_t size);
+    void publish(CityIndex i, const WeatherSnapshot* weather);
+    void releaseWeather();
+
+    std::atomic<size_t> slots_;
+    size_t liveCount_;
+    std::vector<uint32_t> freeSlots_;
+    CityBitset live_;
+    NameTable names_;
+    std::vector<CityIndex> firstByName_; // Oldest live city of each name, by name id
+    std::vector<CityIndex> lastByName_;  // Newest live city of each name, by name id
+    CityColumn<std::atomic<uint32_t>> generation_;
+    CityColumn<uint32_t> nameIds_;
+    CityColumn<const std::string*> name_; // Into names_, whose strings never move
+    CityColumn<CityIndex> nextByName_;     // Live cities of one name, oldest to newest, so a
+    CityColumn<CityIndex> previousByName_; // removal unlinks in O(1) instead of searching
+    CityColumn<double> lon_;
+    CityColumn<double> lat_;
+    CityBitset selected_;
+    CityBitset favorite_;
+    mutable RcuDomain rcu_;
+    CityColumn<std::atomic<const WeatherSnapshot*>> weather_;
+    CityColumn<int32_t> owmId_;
+    CityColumn<CacheValidators> validators_;
+};
+
+#endif // CITYSTORE_H
@@ -0,0 +1,99 @@
+// ConnectionPool.h
+
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <httplib.h>
+#include "HostResolver.h"
+
+// Connection Pool: Keeps idle keep-alive httplib clients for one upstream host so that
+// fetch workers can borrow an already connected socket instead of paying DNS + TCP
+// setup on every request. Each borrowed client is used by a single thread at a time.
+// With a resolver, new clients connect to its cached address instead of looking the host up.
+class ConnectionPool {
+public:
+    // Snapshot of the pool counters.
+    struct Stats {
+        uint64_t acquired;   // Number of clients handed out
+        uint64_t reused;     // Clients handed out with a socket that was still open
+        uint64_t created;    // Clients constructed because no idle one was available
+        uint64_t evicted;    // Idle clients closed because they exceeded the idle timeout
+        uint64_t discarded;  // Clients dropped on release (pool full or request failed)
+        uint64_t warmed;     // Connections opened ahead of demand by warmUp()
+        size_t idle;         // Clients currently waiting in the pool
+
+        double reuseRate() const { return acquired ? static_cast<double>(reused) / acquired : 0.0; }
+    };
+
+    // RAII handle to a borrowed client; gives the client back to the pool when destroyed.
+    class Lease {
+    public:
+        Lease(ConnectionPool* pool, std::unique_ptr<httplib::Client> client);
+        Lease(Lease&& other);
+        ~Lease();
+
+        httplib::Client* operator->() const { return client_.get(); }
+        httplib::Client& operator*() const { return *client_; }
+
+        // Marks the connection as unusable so it is closed instead of returned.
+        void discard() { reusable_ = false; }
+
+    private:
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ConnectionPool* pool_;
+        std::unique_ptr<httplib::Client> client_;
+        bool reusable_;
+    };
+
+    ConnectionPool(const std::string& host, size_t maxIdle, std::chrono::seconds idleTimeout,
+        HostResolver* resolver = nullptr);
+
+    Lease acquire();
+    size_t warmUp(size_t count, std::chrono::milliseconds timeout);
+    void configure(size_t maxIdle, std::chrono::seconds idleTimeout);
+    void evictIdle();
+    void stopAll(); // Aborts requests running on borrowed clients and closes idle ones
+    bool stopped() const { return stopped_; } // After stopAll(), no request should be started
+    Stats stats() const;
+    const std::string& hostname() const { return hostname_; }
+
+private:
+    struct IdleClient {
+        std::unique_ptr<httplib::Client> client;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    std::unique_ptr<httplib::Client> createClient() const;
+    void release(std::unique_ptr<httplib::Client> client, bool reusable);
+    void evictIdleLocked(std::chrono::steady_clock::time_point now, std::deque<IdleClient>& evicted);
+
+    const std::string host_;
+    std::string hostname_; // host_ without scheme and port, as the resolver and httplib key it
+    HostResolver* resolver_;
+    size_t maxIdle_;
+    std::chrono::seconds idleTimeout_;
+
+    mutable std::mutex mutex_;
+    std::deque<IdleClient> idle_; // Most recently used client at the back
+    std::set<httplib::Client*> leased_; // Clients currently borrowed, so stopAll() can reach them
+    std::atomic<bool> stopped_;
+
+    std::atomic<uint64_t> acquired_;
+    std::atomic<uint64_t> reused_;
+    std::atomic<uint64_t> created_;
+    std::atomic<uint64_t> evicted_;
+    std::atomic<uint64_t> discarded_;
+    std::atomic<uint64_t> warmed_;
+};
+
+#endif // CONNECTIONPOOL_H
@@ -0,0 +1,39 @@
+// GzipDecoder.h
+
+#ifndef GZIPDECODER_H
+#define GZIPDECODER_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Output callback for decoded bytes; returning false aborts decoding.
+typedef std::function<bool(const char* data, size_t size)> DecodedSink;
+
+// Gzip Decoder: Streaming gzip/deflate decoder. Compressed bytes can be fed in pieces as
+// they arrive and are inflated straight into the sink, so the compressed body is never
+// buffered. Needs zlib (CPPHTTPLIB_ZLIB_SUPPORT); without it available() is false.
+class GzipDecoder {
+public:
+    GzipDecoder();
+    ~GzipDecoder();
+
+    static bool available();
+
+    bool feed(const char* data, size_t size, const DecodedSink& sink);
+    bool failed() const { return failed_; }
+
+private:
+    GzipDecoder(const GzipDecoder&) = delete;
+    GzipDecoder& operator=(const GzipDecoder&) = delete;
+
+    struct Stream;
+    std::unique_ptr<Stream> stream_;
+    bool failed_;
+};
+
+// Function to Check Whether a Content-Encoding Header Value Is One GzipDecoder Understands
+bool isGzipEncoding(const std::string& contentEncoding);
+
+#endif // GZIPDECODER_H
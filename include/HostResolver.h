@@ -0,0 +1,54 @@
+// HostResolver.h
+
+#ifndef HOSTRESOLVER_H
+#define HOSTRESOLVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Host Resolver: Caches the address a host name resolves to for a fixed time to live, so new
+// connections skip the DNS lookup. getaddrinfo() does not report the record's TTL, so every
+// entry lives for the configured one. When a refresh fails the last known address is served.
+class HostResolver {
+public:
+    // Snapshot of the resolver counters.
+    struct Stats {
+        uint64_t hits;       // Answers served from the cache
+        uint64_t lookups;    // getaddrinfo() calls made
+        uint64_t failures;   // Lookups that returned no address
+        double lastLookupMs; // Duration of the most recent lookup
+    };
+
+    explicit HostResolver(std::chrono::seconds ttl);
+
+    std::string resolve(const std::string& host); // Numeric address, or empty if unresolvable
+    void expire(const std::string& host); // The next resolve() looks the host up again
+    void configure(std::chrono::seconds ttl);
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string address;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    HostResolver(const HostResolver&) = delete;
+    HostResolver& operator=(const HostResolver&) = delete;
+
+    static std::string lookup(const std::string& host);
+
+    std::chrono::seconds ttl_;
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> lookups_;
+    std::atomic<uint64_t> failures_;
+    std::atomic<double> lastLookupMs_;
+};
+
+#endif // HOSTRESOLVER_H
@@ -0,0 +1,60 @@
+// JsonStreamParser.h
+
+#ifndef JSONSTREAMPARSER_H
+#define JSONSTREAMPARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <json.hpp>
+
+// JSON Stream Parser: Push-style JSON parser. The document can be fed in pieces of any size
+// as it arrives from the socket, and SAX events are passed to the handler as soon as each
+// token is complete, so the raw text is never buffered; only the token being read and the
+// nesting stack are kept. finish() must be called after the last piece. After a syntax error,
+// or once the handler returns false, the parser stops and every later call returns false.
+class JsonStreamParser {
+public:
+    typedef nlohmann::json_sax<nlohmann::json> Handler;
+
+    explicit JsonStreamParser(Handler& handler);
+
+    bool feed(const char* data, size_t size);
+    bool finish(); // True once a single complete value was parsed
+    bool failed() const { return state_ == Failed; }
+    size_t position() const { return position_; } // Bytes consumed so far
+
+private:
+    enum State { Value, KeyOrEnd, Key, Colon, ObjectNext, ValueOrEnd, ArrayNext, Done, Failed };
+    enum Token { NoToken, StringToken, EscapeToken, UnicodeToken, NumberToken, LiteralToken };
+
+    JsonStreamParser(const JsonStreamParser&) = delete;
+    JsonStreamParser& operator=(const JsonStreamParser&) = delete;
+
+    size_t readString(const char* data, size_t size);
+    bool readEscape(char c);
+    bool readUnicode(char c);
+    bool readLiteral(char c);
+    bool structural(char c);
+    bool startValue(char c);
+    bool endString();
+    bool endNumber();
+    bool endLiteral();
+    bool valueDone(bool accepted);
+    bool fail(const std::string& message);
+    bool stop();
+
+    Handler& handler_;
+    State state_;
+    Token token_;
+    std::string text_;        // String, number or literal being read
+    std::vector<char> stack_; // '{' or '[' per open container
+    bool readingKey_;
+    unsigned codeUnit_;       // \uXXXX escape being read
+    int codeDigits_;
+    unsigned highSurrogate_;  // Pending first half of a surrogate pair
+    size_t position_;
+};
+
+#endif // JSONSTREAMPARSER_H
@@ -0,0 +1,66 @@
+// MpscQueue.h
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// MPSC Queue: An unbounded multi-producer, single-consumer FIFO. Producers on any thread push
+// with one atomic exchange and never wait on each other or on the consumer; only one thread
+// may pop. Values pushed by one producer come out in the order it pushed them.
+//
+// Nodes form a list from an oldest stub node (tail_) to the newest (head_). A producer swings
+// head_ to its node and then links the previous head to it, so for the moment in between the
+// consumer sees the list end early; pop() then reports the queue empty and the value shows up
+// on a later pop.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+    ~MpscQueue() {
+        T value;
+        while (pop(value)) {
+        }
+        delete tail_;
+    }
+
+    // Function to Append a Value; any thread
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // Function to Take the Oldest Value; only the consumer thread. False when empty.
+    bool pop(T& value) {
+        Node* next = tail_->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        value = std::move(next->value);
+        delete tail_;
+        tail_ = next; // The node just read becomes the new stub
+        return true;
+    }
+
+    // Whether the consumer would find nothing to pop; only the consumer thread.
+    bool empty() const { return !tail_->next.load(std::memory_order_acquire); }
+
+private:
+    struct Node {
+        Node() : value(), next(nullptr) {}
+        explicit Node(T&& value) : value(std::move(value)), next(nullptr) {}
+
+        T value;
+        std::atomic<Node*> next;
+    };
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    std::atomic<Node*> head_; // Newest node, swung by producers
+    Node* tail_;              // Stub before the oldest value, owned by the consumer
+};
+
+#endif // MPSCQUEUE_H
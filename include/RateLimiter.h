@@ -0,0 +1,96 @@
+// RateLimiter.h
+
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "CancellationToken.h"
+
+// Request Priorities: Interactive requests (a user waiting on "Add City") are always granted
+// ahead of queued Background requests (weather refreshes).
+enum class RequestPriority { Interactive, Background };
+
+// Visibility Hint: Tells whether a background request is for something on screen right now.
+typedef std::function<bool()> VisibilityHint;
+
+// Rate Limiter: Token bucket that paces upstream calls to the API quota. Tokens refill
+// continuously at the configured rate up to the burst size; a request that finds the
+// bucket empty waits in its priority queue instead of being rejected, and a dispatcher
+// thread grants queued requests one by one as tokens come back. A rate of 0 disables pacing.
+// Background requests with a visibility hint that holds are granted before the other
+// background requests; reprioritize() re-reads the hints after the view changes.
+class RateLimiter {
+public:
+    // Snapshot of the limiter counters.
+    struct Stats {
+        size_t queuedInteractive;  // Requests currently waiting, per priority
+        size_t queuedVisible;      // Background requests whose visibility hint holds
+        size_t queuedBackground;
+        uint64_t granted;          // Requests let through since startup
+        uint64_t delayed;          // Granted requests that had to wait for a token
+        uint64_t skipped;          // Cancelled jobs, and jobs queued at shutdown, released without a token
+        double averageWaitMs;      // Mean time from request to grant
+        double maxWaitMs;
+
+        size_t queued() const { return queuedInteractive + queuedVisible + queuedBackground; }
+    };
+
+    RateLimiter(double callsPerMinute, double burst);
+    ~RateLimiter();
+
+    // Function to Run a Job Once a Token Is Available; the job runs on the dispatcher
+    // thread, so it should only hand work off (submit to a pool, start an async request).
+    // A job whose cancellation token has fired runs as soon as it reaches the front of its
+    // queue without spending a token, so it can fail fast instead of using up quota. Jobs
+    // still queued at shutdown, or scheduled after it, are released the same way.
+    void schedule(RequestPriority priority, std::function<void()> job, CancellationToken cancellation = CancellationToken(),
+        VisibilityHint visible = VisibilityHint());
+    // Function to Block Until a Token Is Granted; false if the limiter shut down first.
+    bool acquire(RequestPriority priority);
+
+    void configure(double callsPerMinute, double burst);
+    void reprioritize(); // Re-reads every queued background request's visibility hint, outside the lock
+    void shutdown(); // Releases queued jobs without a token; blocked acquire() calls return false
+    Stats stats() const;
+
+private:
+    struct Ticket;
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    void refillLocked(std::chrono::steady_clock::time_point now);
+    void grantLocked(const std::shared_ptr<Ticket>& ticket, std::chrono::steady_clock::time_point now);
+    void dispatchLoop();
+    std::deque<std::shared_ptr<Ticket>>& queueFor(RequestPriority priority, const std::shared_ptr<Ticket>& ticket);
+    static bool onScreen(const std::shared_ptr<Ticket>& ticket);
+
+    double ratePerSecond_;
+    double burst_;
+    double tokens_;
+    std::chrono::steady_clock::time_point lastRefill_;
+    std::deque<std::shared_ptr<Ticket>> interactive_;
+    std::deque<std::shared_ptr<Ticket>> visible_; // Background requests for what is on screen
+    std::deque<std::shared_ptr<Ticket>> background_;
+    uint64_t nextSequence_; // Orders tickets when reprioritize() merges the background queues
+    uint64_t granted_;
+    uint64_t delayed_;
+    uint64_t skipped_;
+    double totalWaitMs_;
+    double maxWaitMs_;
+    bool stopping_;
+    mutable std::mutex mutex_;
+    std::condition_variable queueChanged_;
+    std::condition_variable ticketGranted_;
+    std::thread dispatcher_;
+};
+
+#endif // RATELIMITER_H
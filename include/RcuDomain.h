@@ -0,0 +1,81 @@
+// RcuDomain.h
+
+#ifndef RCUDOMAIN_H
+#define RCUDOMAIN_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// RCU Domain: Epoch-based reclamation for immutable objects published through atomic pointers.
+// A reader wraps its loads in a ReadGuard, which announces the current epoch with one store
+// and never blocks; pointers must be loaded sequentially consistent inside it. A writer swaps
+// in a new object and retire()s the old one, which is deleted once the epoch has moved two
+// steps past its retirement: the epoch only advances when every reader inside a guard has
+// seen the current one, so by then no reader can still hold the old pointer. Each thread gets
+// a reader slot on its first guard, handed back when the thread exits.
+class RcuDomain {
+    struct Reader;
+
+public:
+    // Read-side critical section: objects loaded inside it stay alive until it ends. Guards
+    // nest, and only the outermost one announces an epoch.
+    class ReadGuard {
+    public:
+        explicit ReadGuard(RcuDomain& domain);
+        ~ReadGuard();
+
+    private:
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        Reader* reader_;
+    };
+
+    // Snapshot of the reclamation counters.
+    struct Stats {
+        uint64_t epoch;
+        uint64_t retired;
+        uint64_t reclaimed;
+        size_t pending; // Retired but not yet deleted
+    };
+
+    RcuDomain();
+    ~RcuDomain(); // Deletes everything still pending; no guard may be open
+
+    template <typename T>
+    void retire(const T* object) {
+        if (object) {
+            retire(const_cast<T*>(object), [](void* p) { delete static_cast<T*>(p); });
+        }
+    }
+    void retire(void* object, void (*deleter)(void*));
+    void collect(); // Advances the epoch if it can and deletes what is safe to delete
+    Stats stats() const;
+
+private:
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    RcuDomain(const RcuDomain&) = delete;
+    RcuDomain& operator=(const RcuDomain&) = delete;
+
+    Reader* reader(); // This thread's slot
+    bool tryAdvance();
+    void reclaim(uint64_t safeBefore);
+
+    const uint64_t id_;
+    std::atomic<uint64_t> epoch_;
+    std::atomic<Reader*> readers_; // Lock-free list of slots, never shrunk
+    mutable std::mutex retiredMutex_;
+    std::vector<Retired> retired_;
+    uint64_t retiredCount_;
+    uint64_t reclaimedCount_;
+};
+
+#endif // RCUDOMAIN_H
@@ -0,0 +1,97 @@
+// RefreshScheduler.h
+
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "CityStore.h"
+
+// Refresh Scheduler: Decides when each tracked key (a city handle) is due for a refresh. Keys
+// sit in a min-heap ordered by due time, so tracking, rescheduling and popping the next due key
+// cost O(log n); untracked or rescheduled keys leave stale heap nodes that are skipped when popped.
+// Each key owns a slot that is spread at random over its interval and then repeats every
+// interval, and each refresh is jittered around its slot, so a large set of keys produces a
+// flat request rate instead of bursts. The scheduler owns no
+// thread: the caller polls takeDue(), e.g. once per frame.
+class RefreshScheduler {
+public:
+    // A key that is due, and whether it was asked for through refreshNow().
+    struct DueRefresh {
+        CityHandle key;
+        bool manual;
+    };
+
+    // Snapshot of the scheduler counters.
+    struct Stats {
+        size_t tracked;
+        size_t manualQueued;       // refreshNow() requests not taken yet
+        uint64_t refreshes;        // Scheduled refreshes handed out
+        uint64_t manualRefreshes;  // refreshNow() requests handed out
+        double nextDueSeconds;     // Until the next scheduled refresh; -1 if nothing is tracked
+        bool paused;
+    };
+
+    explicit RefreshScheduler(double jitter);
+
+    void track(CityHandle key, std::chrono::seconds interval); // Keeps the due time if already tracked
+    void untrack(CityHandle key);
+    bool tracking(CityHandle key) const;
+    void refreshNow(CityHandle key); // Ahead of every scheduled refresh, even while paused
+    void rescheduleAt(CityHandle key, std::chrono::steady_clock::time_point earliest);
+
+    void pause();
+    void resume(); // Due times move forward by the time spent paused
+    bool paused() const;
+
+    std::vector<DueRefresh> takeDue(std::chrono::steady_clock::time_point now, size_t maxCount);
+    Stats stats() const;
+
+private:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    struct Entry {
+        std::chrono::seconds interval;
+        TimePoint slot; // Unjittered refresh time; advances by exactly one interval
+        TimePoint due;  // slot plus this round's jitter
+        uint64_t version; // Matches the one live heap node for this key
+        bool manualQueued;
+    };
+    struct HeapNode {
+        TimePoint due;
+        uint64_t version;
+        CityHandle key;
+    };
+    struct LaterDue {
+        bool operator()(const HeapNode& a, const HeapNode& b) const { return a.due > b.due; }
+    };
+
+    RefreshScheduler(const RefreshScheduler&) = delete;
+    RefreshScheduler& operator=(const RefreshScheduler&) = delete;
+
+    void scheduleLocked(CityHandle key, Entry& entry, TimePoint due);
+    std::chrono::steady_clock::duration jitterLocked(std::chrono::seconds interval);
+    void dropStaleTopLocked();
+    void rebuildHeapLocked();
+
+    const double jitter_; // Refreshes land within this fraction of an interval of their slot
+    mutable std::mutex mutex_;
+    std::unordered_map<CityHandle, Entry, CityHandleHash> entries_;
+    std::priority_queue<HeapNode, std::vector<HeapNode>, LaterDue> heap_;
+    std::deque<CityHandle> manual_;
+    uint64_t nextVersion_;
+    std::mt19937 random_;
+    bool paused_;
+    TimePoint pausedAt_;
+    uint64_t refreshes_;
+    uint64_t manualRefreshes_;
+};
+
+#endif // REFRESHSCHEDULER_H
@@ -0,0 +1,136 @@
+// ResilientFetcher.h
+
+#ifndef RESILIENTFETCHER_H
+#define RESILIENTFETCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "AsyncHttpClient.h"
+#include "CancellationToken.h"
+#include "RateLimiter.h"
+#include "TimerQueue.h"
+
+// Retry Options: Limits for one logical request across all of its attempts.
+struct RetryOptions {
+    std::chrono::milliseconds deadline;    // From the first attempt being sent to giving up
+    int maxAttempts;                       // First attempt included; hedges do not count
+    std::chrono::milliseconds backoffBase; // Backoff before retry n is jittered around base * 2^(n-1)
+    std::chrono::milliseconds backoffCap;
+    double retryBudgetRatio;               // Retry/hedge tokens earned per request sent
+    double retryBudgetCap;                 // Most tokens that can be saved up
+    bool hedging;                          // Send a duplicate when an attempt outlives the hedge percentile
+    double hedgePercentile;
+    size_t hedgeMinSamples;                // Latency samples needed before hedging starts
+};
+
+// Latency Tracker: Keeps the most recent latency samples and answers percentile queries.
+class LatencyTracker {
+public:
+    explicit LatencyTracker(size_t capacity = 512);
+
+    void record(double milliseconds);
+    double percentile(double fraction) const; // 0 when there are no samples
+    size_t samples() const;
+
+private:
+    std::vector<double> samples_;
+    size_t next_;
+    size_t count_;
+    mutable std::mutex mutex_;
+};
+
+// Retry Budget: Each request earns a fraction of a token and each retry or hedge spends a
+// whole one, so extra attempts stay a bounded share of traffic when the upstream is failing.
+class RetryBudget {
+public:
+    RetryBudget(double ratio, double cap);
+
+    void deposit();
+    bool withdraw();
+
+private:
+    double ratio_;
+    double cap_;
+    double balance_;
+    std::mutex mutex_;
+};
+
+// Sends one attempt with the given timeout; done must be called exactly once.
+typedef std::function<void(std::chrono::milliseconds timeout, AsyncCallback done)> AttemptSender;
+
+// Resilient Fetcher: Wraps a request with a deadline, retries on transport errors, 429 and
+// 5xx using jittered exponential backoff under a retry budget, and optionally hedges by
+// sending a duplicate once an attempt has been outstanding longer than the observed
+// latency percentile. The callback receives the first usable response; when the request
+// gives up it receives the last error response, or nullptr if there was none. Every
+// attempt, hedges and retries included, is released through the rate limiter if one is set.
+// Once the cancellation token fires no further attempt is sent and the callback gets nullptr
+// (an attempt already on the wire is left to finish). The visibility hint is handed to the
+// rate limiter with every attempt. Shutting down fails every request not yet answered, and
+// any fetched afterwards, with nullptr.
+class ResilientFetcher {
+public:
+    // Snapshot of the fetcher counters.
+    struct Stats {
+        uint64_t requests;
+        uint64_t retries;
+        uint64_t hedges;
+        uint64_t hedgeWins;       // Requests answered by the hedge rather than the original
+        uint64_t deadlineMisses;
+        uint64_t budgetDenied;    // Retries or hedges skipped because the budget was empty
+        uint64_t cancelled;       // Requests abandoned through their cancellation token
+        double p50Ms;             // Attempt latency percentiles
+        double p95Ms;
+        double p99Ms;
+    };
+
+    ResilientFetcher(const RetryOptions& options, RateLimiter* limiter = nullptr);
+    ~ResilientFetcher();
+
+    void fetch(RequestPriority priority, AttemptSender send, AsyncCallback callback,
+        CancellationToken cancellation = CancellationToken(), VisibilityHint visible = VisibilityHint());
+    void shutdown(); // Pending retries and hedges are dropped; unanswered requests get nullptr
+
+    void setHedging(bool enabled) { hedging_ = enabled; }
+    bool hedging() const { return hedging_; }
+    Stats stats() const;
+
+private:
+    struct Request;
+
+    ResilientFetcher(const ResilientFetcher&) = delete;
+    ResilientFetcher& operator=(const ResilientFetcher&) = delete;
+
+    void startAttempt(const std::shared_ptr<Request>& request, bool hedge);
+    void sendAttempt(const std::shared_ptr<Request>& request, bool hedge);
+    void attemptDone(const std::shared_ptr<Request>& request, std::chrono::steady_clock::time_point sent,
+        bool hedge, const httplib::Response* res);
+    void finish(const std::shared_ptr<Request>& request, const httplib::Response* res);
+    std::chrono::milliseconds backoff(int attempt) const;
+
+    RetryOptions options_;
+    std::mutex activeMutex_;
+    std::unordered_map<Request*, std::weak_ptr<Request>> active_; // Requests not yet answered
+    bool stopped_;
+    RateLimiter* limiter_;
+    TimerQueue timers_;
+    LatencyTracker latency_;
+    RetryBudget budget_;
+    std::atomic<bool> hedging_;
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> retries_;
+    std::atomic<uint64_t> hedges_;
+    std::atomic<uint64_t> hedgeWins_;
+    std::atomic<uint64_t> deadlineMisses_;
+    std::atomic<uint64_t> budgetDenied_;
+    std::atomic<uint64_t> cancelled_;
+};
+
+#endif // RESILIENTFETCHER_H
@@ -0,0 +1,88 @@
+// SingleFlight.h
+
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Single Flight: Coalesces concurrent work for the same key. The first caller to join a key
+// leads the flight and must call complete() once its result is ready; callers that join
+// while the flight is open only queue a waiter. Every waiter, the leader's included, is
+// invoked exactly once with the leader's result, on the thread that calls complete().
+// Each flight also remembers the newest generation (e.g. fetch cycle) among its callers, so
+// the leader can tell whether anyone current still wants the result.
+template <typename Result>
+class SingleFlight {
+public:
+    typedef std::function<void(const Result& result)> Waiter;
+
+    SingleFlight() : coalesced_(0) {}
+
+    // Function to Join the Flight for a Key; true means the caller leads it
+    bool join(const std::string& key, Waiter waiter, uint64_t generation = 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = flights_.find(key);
+        if (it != flights_.end()) {
+            it->second.waiters.push_back(std::move(waiter));
+            it->second.generation = std::max(it->second.generation, generation);
+            coalesced_++;
+            return false;
+        }
+        Flight& flight = flights_[key];
+        flight.waiters.push_back(std::move(waiter));
+        flight.generation = generation;
+        return true;
+    }
+
+    // Function to Read the Newest Generation Waiting on a Key; 0 when nothing is in flight
+    uint64_t newestGeneration(const std::string& key) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = flights_.find(key);
+        return it != flights_.end() ? it->second.generation : 0;
+    }
+
+    // Function to Close the Flight for a Key and Hand the Result to All of Its Waiters
+    void complete(const std::string& key, const Result& result) {
+        std::vector<Waiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = flights_.find(key);
+            if (it == flights_.end()) {
+                return;
+            }
+            waiters.swap(it->second.waiters);
+            flights_.erase(it);
+        }
+        for (auto& waiter : waiters) {
+            waiter(result);
+        }
+    }
+
+    size_t inFlight() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return flights_.size();
+    }
+    uint64_t coalesced() const { return coalesced_; } // Callers that joined an open flight
+
+private:
+    struct Flight {
+        std::vector<Waiter> waiters;
+        uint64_t generation;
+    };
+
+    SingleFlight(const SingleFlight&) = delete;
+    SingleFlight& operator=(const SingleFlight&) = delete;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Flight> flights_;
+    std::atomic<uint64_t> coalesced_;
+};
+
+#endif // SINGLEFLIGHT_H
@@ -0,0 +1,71 @@
+// TaskScheduler.h
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Task Scheduler: Work-stealing executor for short CPU-bound tasks, one worker per hardware
+// thread. Each worker has its own deque: tasks submitted from a worker go on the back of its
+// own deque and are popped from the back (newest first, while their data is still in cache),
+// tasks submitted from other threads are dealt round-robin across the deques, and a worker
+// whose deque is empty steals the oldest task from the front of another's. Workers only sleep
+// when every deque is empty. Tasks must not block; I/O belongs on a WorkerPool.
+class TaskScheduler {
+public:
+    // Snapshot of the scheduler counters.
+    struct Stats {
+        uint64_t executed;
+        uint64_t stolen; // Executed by a worker other than the one whose deque held them
+        size_t pending;
+    };
+
+    // A thread count of 0 sizes the scheduler from std::thread::hardware_concurrency().
+    explicit TaskScheduler(size_t threadCount = 0);
+    ~TaskScheduler();
+
+    void submit(std::function<void()> task);
+    void waitIdle();
+    void shutdown(); // Queued tasks, and any submitted afterwards, run on the calling thread
+
+    bool onWorker() const; // Whether the calling thread is one of this scheduler's workers
+    size_t threadCount() const { return workers_.size(); }
+    Stats stats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+        std::thread thread;
+    };
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    void workerLoop(size_t self);
+    bool take(size_t self, std::function<void()>& task);
+    void finished();
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> nextWorker_;  // Round-robin target for tasks submitted from outside
+    std::atomic<size_t> queued_;      // Tasks in all deques
+    std::atomic<size_t> running_;
+    std::atomic<size_t> sleepers_;
+    std::atomic<uint64_t> executed_;
+    std::atomic<uint64_t> stolen_;
+    std::atomic<bool> stopping_;
+    std::mutex sleepMutex_;
+    std::condition_variable taskAvailable_;
+    std::condition_variable idle_;
+};
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,59 @@
+// TimerQueue.h
+
+#ifndef TIMERQUEUE_H
+#define TIMERQUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Timer Queue: Runs delayed callbacks on one background thread, earliest deadline first.
+// Callbacks should be short (start a request, flip a flag); timers still pending at
+// shutdown are dropped. Cancelling a timer releases its callback, and whatever the callback
+// holds, at once rather than at its deadline.
+class TimerQueue {
+public:
+    typedef uint64_t Id;
+
+    TimerQueue();
+    ~TimerQueue();
+
+    Id schedule(std::chrono::milliseconds delay, std::function<void()> callback);
+    bool cancel(Id id); // False if the timer already ran, or is running
+    void shutdown();
+
+    size_t pending() const;
+
+private:
+    // A cancelled timer stays in the heap until its deadline, without its callback.
+    struct Timer {
+        std::chrono::steady_clock::time_point due;
+        uint64_t sequence; // Keeps timers with the same deadline in scheduling order; also the Id
+    };
+    struct Later {
+        bool operator()(const Timer& a, const Timer& b) const {
+            return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+        }
+    };
+
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    void timerLoop();
+
+    std::priority_queue<Timer, std::vector<Timer>, Later> timers_;
+    std::unordered_map<Id, std::function<void()>> callbacks_; // Of the timers not yet run or cancelled
+    uint64_t nextSequence_;
+    bool stopping_;
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::thread thread_;
+};
+
+#endif // TIMERQUEUE_H
@@ -0,0 +1,72 @@
+// UpdateCadence.h
+
+#ifndef UPDATECADENCE_H
+#define UPDATECADENCE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include "CityStore.h"
+
+// Update Cadence: Learns how often each key's upstream observation changes from the `dt`
+// timestamps of successive responses, and says how long to wait before the next fetch so it
+// lands just after the next observation is expected to be published. Keys are city handles, so
+// two cities of the same name keep separate histories. Gaps between observations can hide
+// missed updates (two cadences apart), so the estimate is the smallest recent gap.
+//
+// Totals across keys are kept up to date by observe() and forget(), so stats() costs the
+// number of distinct cadences rather than the number of keys and can run every frame.
+class UpdateCadence {
+public:
+    // Snapshot of the cadence counters, compared with polling every fixedInterval.
+    struct Stats {
+        size_t keys;
+        uint64_t fetches;          // Responses observed
+        uint64_t unchanged;        // Responses that carried no new observation
+        uint64_t fixedPolls;       // Fetches polling every fixedInterval would have made, summed before rounding
+        double medianCadence;      // Seconds between observations across keys; 0 if unknown
+
+        long long avoided() const { return static_cast<long long>(fixedPolls) - static_cast<long long>(fetches); }
+    };
+
+    UpdateCadence(std::chrono::seconds margin, std::chrono::seconds minimumWait, std::chrono::seconds maximumWait);
+
+    // Records a response for key observed at unix time dt and fetched at unix time now; returns
+    // how long to wait before fetching again, or 0 while the cadence is still unknown.
+    std::chrono::seconds observe(CityHandle key, long long dt, long long now);
+    void forget(CityHandle key);
+    std::chrono::seconds cadence(CityHandle key) const; // 0 while unknown
+    Stats stats(std::chrono::seconds fixedInterval, long long now) const;
+
+private:
+    struct Station {
+        long long lastDt;
+        long long firstFetch;
+        long long delay;            // Estimated seconds from an observation to its publication
+        uint64_t fetches;
+        uint64_t unchanged;
+        std::deque<long long> gaps; // Most recent gaps between distinct observations
+    };
+
+    UpdateCadence(const UpdateCadence&) = delete;
+    UpdateCadence& operator=(const UpdateCadence&) = delete;
+
+    static long long cadenceOf(const Station& station);
+    void countCadence(long long cadence, int delta); // Under mutex_
+
+    const std::chrono::seconds margin_;  // Least publication delay assumed, and the step it adapts by
+    const std::chrono::seconds minimumWait_;
+    const std::chrono::seconds maximumWait_;
+    mutable std::mutex mutex_;
+    std::unordered_map<CityHandle, Station, CityHandleHash> stations_;
+    uint64_t fetches_;                      // Totals over stations_
+    uint64_t unchanged_;
+    long long firstFetchSum_;
+    std::map<long long, size_t> cadences_;  // Stations per known cadence
+};
+
+#endif // UPDATECADENCE_H
@@ -0,0 +1,137 @@
+// WeatherFields.h
+
+#ifndef WEATHERFIELDS_H
+#define WEATHERFIELDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <json.hpp>
+#include "JsonStreamParser.h"
+
+struct WeatherSnapshot;
+
+// Weather Fields: The values the app uses from one OpenWeatherMap current-weather object, in
+// the API's units. found has a bit set for each field the object contained.
+struct WeatherFields {
+    enum Field {
+        Id = 1 << 0,
+        Time = 1 << 1,
+        Description = 1 << 2,
+        Temperature = 1 << 3,
+        Humidity = 1 << 4,
+        WindSpeed = 1 << 5,
+        Sunrise = 1 << 6,
+        Sunset = 1 << 7
+    };
+
+    WeatherFields() : found(0), id(0), dt(0), temp(0.0), humidity(0), windSpeed(0.0), sunrise(0), sunset(0) {}
+
+    WeatherSnapshot snapshot() const;
+
+    unsigned found;
+    int id;
+    long long dt;            // Observation time, Unix seconds
+    std::string description; // Of the first weather condition
+    double temp;             // Kelvin
+    int humidity;            // Percent
+    double windSpeed;        // m/s
+    long long sunrise;
+    long long sunset;
+};
+
+// Weather Snapshot: Compact, fixed-size copy of a city's weather for display, built once when
+// the response arrives. Units are converted on the way in (temperature in °C) and sunrise and
+// sunset are also kept formatted as local HH:MM. valid has the WeatherFields::Field bit of each
+// field that holds data; a value-initialized snapshot (valid 0) means no weather.
+struct WeatherSnapshot {
+    bool empty() const { return valid == 0; }
+    bool has(unsigned field) const { return (valid & field) != 0; }
+
+    uint32_t valid;
+    float temperatureC;
+    float windSpeed;      // m/s
+    int32_t humidity;     // Percent
+    int64_t observedAt;   // Unix seconds
+    int64_t sunrise;
+    int64_t sunset;
+    char sunriseText[6];  // HH:MM, local time
+    char sunsetText[6];
+    char description[36]; // Truncated to fit
+};
+
+static_assert(std::is_pod<WeatherSnapshot>::value, "WeatherSnapshot is copied and cleared as plain memory");
+
+// Weather Field Extractor: SAX handler that copies the fields of a current-weather response,
+// or of each entry in a group response's "list", into WeatherFields. Everything else is
+// skipped as it is read, so no DOM is built; only the description string is stored.
+class WeatherFieldExtractor : public nlohmann::json_sax<nlohmann::json> {
+public:
+    WeatherFieldExtractor();
+
+    WeatherFields& fields() { return root_; }            // The top-level object
+    std::vector<WeatherFields>& list() { return list_; } // Entries of "list", in order
+    bool failed() const { return failed_; }
+
+    bool null() override;
+    bool boolean(bool value) override;
+    bool number_integer(number_integer_t value) override;
+    bool number_unsigned(number_unsigned_t value) override;
+    bool number_float(number_float_t value, const string_t& text) override;
+    bool string(string_t& value) override;
+    bool binary(binary_t& value) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& value) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string& token, const nlohmann::detail::exception& error) override;
+
+private:
+    enum Scope { Skip, Entry, Main, Wind, Sys, Conditions, Condition, List };
+    enum Key { OtherKey, IdKey, DtKey, MainKey, WindKey, SysKey, WeatherKey, ListKey, TempKey, HumidityKey,
+        SpeedKey, SunriseKey, SunsetKey, DescriptionKey };
+
+    static const size_t kMaxDepth = 16; // Deeper containers are skipped without being tracked
+
+    Scope scope() const;
+    Scope childScope(bool array);
+    void enter(Scope scope);
+    void leave();
+    WeatherFields& entry();
+    bool number(double value);
+
+    Scope scopes_[kMaxDepth];
+    size_t depth_;
+    size_t listDepth_;   // Depth of the "list" array, 0 outside of it
+    bool firstCondition_;
+    Key key_;
+    WeatherFields root_;
+    std::vector<WeatherFields> list_;
+    bool failed_;
+};
+
+// Streamed Weather: Extracts the weather fields of one response body from pieces fed as they
+// arrive.
+class StreamedWeather {
+public:
+    StreamedWeather() : parser_(extractor_) {}
+
+    bool feed(const char* data, size_t size) { return parser_.feed(data, size); }
+    bool finish() { return parser_.finish(); }
+    WeatherFieldExtractor& extractor() { return extractor_; }
+
+private:
+    StreamedWeather(const StreamedWeather&) = delete;
+    StreamedWeather& operator=(const StreamedWeather&) = delete;
+
+    WeatherFieldExtractor extractor_;
+    JsonStreamParser parser_;
+};
+
+// Function to Extract the Weather Fields of a Complete Response Body
+bool extractWeatherFields(const std::string& body, WeatherFieldExtractor& extractor);
+
+#endif // WEATHERFIELDS_H
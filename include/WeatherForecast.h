@@ -11,11 +11,28 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <future>
+#include <algorithm>
 #include <json.hpp>
 #include <httplib.h>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "imgui.h"
+#include "HostResolver.h"
+#include "ConnectionPool.h"
+#include "WorkerPool.h"
+#include "AsyncHttpClient.h"
+#include "SingleFlight.h"
+#include "RateLimiter.h"
+#include "ResilientFetcher.h"
+#include "CancellationToken.h"
+#include "CircuitBreaker.h"
+#include "RefreshScheduler.h"
+#include "UpdateCadence.h"
+#include "WeatherFields.h"
+#include "CityStore.h"
+#include "MpscQueue.h"
+#include "TaskScheduler.h"
 #include <imgui/backend/imgui_impl_glfw.h>
 #include <imgui/backend/imgui_impl_opengl3.h>
 
@@ -23,34 +40,342 @@
 extern const std::string base_url;
 extern const std::string favorites_file;
 extern std::string api_key;
+extern const std::string api_host;
+extern const size_t fetch_worker_count;
+extern const size_t task_worker_count;
+extern const size_t group_batch_size;
+extern const size_t event_loop_threads;
+extern const size_t event_loop_max_connections;
+extern const double api_calls_per_minute;
+extern const double api_burst;
+extern const RetryOptions fetch_retry_options;
+extern const std::chrono::seconds dns_cache_ttl;
+extern const size_t warm_connection_count;
+extern const std::chrono::milliseconds warm_up_timeout;
+extern const BreakerOptions circuit_breaker_options;
+extern const std::chrono::seconds auto_refresh_interval;
+extern const double auto_refresh_jitter;
+extern const size_t refreshes_per_frame;
+extern const std::chrono::seconds observation_margin;
+extern const std::chrono::seconds minimum_refresh_wait;
+extern const std::chrono::seconds maximum_refresh_wait;
+extern const size_t result_batch_size;
+extern const std::chrono::microseconds result_apply_budget;
 
-// Struct Definition: Defines a data structure to hold information about a city.
-struct City {
-    std::string name;
+// Fetch Backends: ThreadPool runs blocking httplib requests on fetchWorkers, EventLoop
+// multiplexes non-blocking requests on a few epoll threads (Linux only), and IoUring batches
+// socket operations through io_uring when built with liburing (otherwise it uses epoll).
+enum class FetchBackend { ThreadPool, EventLoop, IoUring };
+
+// Fetch Options
+extern std::atomic<bool> batchFetchMode;
+extern std::atomic<uint64_t> fetchGeneration; // Generation of the current fetch cycle
+extern std::atomic<FetchBackend> fetchBackend;
+extern std::atomic<bool> compressedTransfer; // Ask for gzip bodies (needs zlib)
+extern std::atomic<bool> streamingParse; // Parse weather bodies while they arrive instead of after
+
+// Weather Flight Result: What one per-city fetch produced, copied to every city that asked
+// for the same location while it was in flight.
+struct CityWeather {
+    CityHandle source;  // City the request was issued for
+    bool received;
+    bool notModified;   // 304: the data came from the source city's cache
+    bool lastKnown;     // Served from memory because the endpoint's circuit breaker is open
+    WeatherSnapshot weatherData;
+    int owmId;
+    CacheValidators validators;
+};
+
+// Weather Result: A finished per-city flight or group request, queued by the thread that
+// finished it and applied to the city store on the UI thread.
+struct WeatherResult {
+    enum Kind { CityResult, GroupResult };
+
+    Kind kind;
+    uint64_t generation; // Of the fetch cycle it was sent for
+    bool counted;        // Counts toward that cycle's progress
+    CityHandle city;     // CityResult: a city that joined the flight...
+    CityWeather weather; // ...and what the flight produced
+    std::vector<CityHandle> batch;                        // GroupResult: the cities asked for...
+    std::vector<std::pair<int, WeatherSnapshot>> entries; // ...and the weather found, by city ID
+    bool serveLastKnown; // GroupResult: the group breaker was not closed when it finished
+    std::chrono::steady_clock::time_point queued;
+};
+
+// Parsed Body: Weather fields of a request's 200 response, extracted while the body streamed
+// in. Shared by the attempts of one request; the first to finish parsing fills it in.
+struct ParsedBody {
+    ParsedBody() : ready(false) {}
+
+    std::mutex mutex;
+    bool ready;
+    WeatherFields fields;            // Of a per-city response
+    std::vector<WeatherFields> list; // Of a group response
+};
+
+// Geocoding Flight Result: Coordinates found for a city name.
+struct GeoLookup {
+    bool found;
     double lon;
     double lat;
-    bool selected;
-    nlohmann::json weatherData;
 };
 
 // Initial List of Cities
-extern std::vector<City> cities;
+extern CityStore cities;
+
+// Cached DNS Answers for the Upstream Host
+extern HostResolver hostResolver;
+
+// Shared Keep-Alive Connections to the OpenWeatherMap Host
+extern ConnectionPool connectionPool;
+
+// Client-Side Pacing of All Calls Against the API Key's Quota
+extern RateLimiter apiRateLimiter;
+
+// Deadlines, Retries and Hedging for Every Upstream Request
+extern ResilientFetcher resilientFetcher;
+
+// Circuit Breakers for Each Upstream Endpoint: per-city weather, group weather and geocoding
+extern CircuitBreaker weatherBreaker;
+extern CircuitBreaker groupBreaker;
+extern CircuitBreaker geocodeBreaker;
+
+// Background Refresh Schedule for the Cities on Display, Keyed by City Handle
+extern RefreshScheduler refreshScheduler;
+
+// Observed Update Cadence of Each City's Weather Station, Keyed by City Handle
+extern UpdateCadence updateCadence;
+
+// Fetch Cycle: One press of "Fetch Weather Data". Cycles are numbered by generation and
+// starting a new one supersedes the last, so a cycle's token is cancelled as soon as
+// fetchGeneration moves past it.
+class FetchCycle {
+public:
+    explicit FetchCycle(uint64_t generation)
+        : generation_(generation), cancellation_([generation] { return fetchGeneration != generation; }) {}
+
+    uint64_t generation() const { return generation_; }
+    const CancellationToken& cancellation() const { return cancellation_; }
+    bool cancelled() const { return cancellation_.cancelled(); }
+
+private:
+    uint64_t generation_;
+    CancellationToken cancellation_;
+};
+
+// Fetch Progress: Counts completed city fetches against the size of the current fetch cycle
+// and keeps the completion time of recent cycles. Completions from older cycles are ignored.
+class FetchProgress {
+public:
+    FetchProgress() : total_(0), completed_(0), generation_(0), startTicks_(0), timed_(true) {}
+
+    void begin(int total, uint64_t generation) {
+        startTicks_ = std::chrono::steady_clock::now().time_since_epoch().count();
+        generation_ = generation;
+        completed_ = 0;
+        timed_ = total == 0;
+        total_ = total;
+    }
+    void complete(uint64_t generation, int count = 1) {
+        if (generation != generation_) {
+            return;
+        }
+        if ((completed_ += count) >= total_ && !timed_.exchange(true)) {
+            long long elapsedTicks = std::chrono::steady_clock::now().time_since_epoch().count() - startTicks_;
+            cycleTimes_.record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::duration(elapsedTicks)).count());
+        }
+    }
+
+    int total() const { return total_; }
+    int completed() const { return completed_; }
+    bool finished() const { return completed_ >= total_; }
+    float fraction() const { return total_ > 0 ? static_cast<float>(completed_) / total_ : 1.0f; }
+    const LatencyTracker& cycleTimes() const { return cycleTimes_; }
+
+private:
+    std::atomic<int> total_;
+    std::atomic<int> completed_;
+    std::atomic<uint64_t> generation_;
+    std::atomic<long long> startTicks_;
+    std::atomic<bool> timed_;
+    LatencyTracker cycleTimes_;
+};
+
+// Transfer Statistics: Response body bytes received on the wire versus after decoding,
+// summed over the current fetch cycle.
+class TransferStats {
+public:
+    TransferStats() : responses_(0), wireBytes_(0), decodedBytes_(0) {}
+
+    void begin() { responses_ = 0; wireBytes_ = 0; decodedBytes_ = 0; }
+    void record(size_t wireBytes, size_t decodedBytes) { responses_++; wireBytes_ += wireBytes; decodedBytes_ += decodedBytes; }
+
+    int responses() const { return responses_; }
+    unsigned long long wireBytes() const { return wireBytes_; }
+    unsigned long long decodedBytes() const { return decodedBytes_; }
+
+private:
+    std::atomic<int> responses_;
+    std::atomic<unsigned long long> wireBytes_;
+    std::atomic<unsigned long long> decodedBytes_;
+};
+
+// Revalidation Statistics: Conditional requests sent and how many of them came back 304 Not
+// Modified, counted since startup.
+class RevalidationStats {
+public:
+    RevalidationStats() : conditional_(0), notModified_(0) {}
+
+    void recordConditional() { conditional_++; }
+    void recordNotModified() { notModified_++; }
+
+    int conditional() const { return conditional_; }
+    int notModified() const { return notModified_; }
+    float hitRate() const { return conditional_ > 0 ? static_cast<float>(notModified_) / conditional_ : 0.0f; }
+
+private:
+    std::atomic<int> conditional_;
+    std::atomic<int> notModified_;
+};
+
+// Result Apply Statistics: How long finished fetches waited in weatherResults before the UI
+// thread applied them, and how much of each frame applying them took.
+class ResultApplyStats {
+public:
+    ResultApplyStats() : queued_(0), taken_(0), lastFrameResults_(0), lastFrameMs_(0.0), maxFrameMs_(0.0) {}
+
+    void recordQueued() { queued_++; }
+    void recordTaken(double waitMs) { taken_++; waits_.record(waitMs); }
+    void recordFrame(size_t results, double ms) {
+        lastFrameResults_ = results;
+        lastFrameMs_ = ms;
+        if (ms > maxFrameMs_) {
+            maxFrameMs_ = ms;
+        }
+    }
+
+    unsigned long long pending() const { return queued_ - taken_; }
+    unsigned long long applied() const { return taken_; }
+    const LatencyTracker& waits() const { return waits_; }
+    size_t lastFrameResults() const { return lastFrameResults_; }
+    double lastFrameMs() const { return lastFrameMs_; }
+    double maxFrameMs() const { return maxFrameMs_; }
+
+private:
+    std::atomic<unsigned long long> queued_;
+    std::atomic<unsigned long long> taken_;
+    size_t lastFrameResults_; // Frame figures are only touched on the UI thread
+    double lastFrameMs_;
+    double maxFrameMs_;
+    LatencyTracker waits_;
+};
+
+// Startup Timings: When each startup phase ran, in milliseconds since launch (construction of
+// the global instance), and how long the first fetch took to put weather on screen. Phases
+// can overlap because the network warm-up runs alongside window and UI setup.
+class StartupTimings {
+public:
+    struct Phase {
+        std::string name;
+        double startMs;
+        double endMs;
+    };
+
+    StartupTimings() : launch_(std::chrono::steady_clock::now()), firstFetchMs_(-1.0), firstWeatherMs_(-1.0) {}
+
+    double sinceLaunchMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launch_).count();
+    }
+    void record(const std::string& name, double startMs) {
+        Phase phase = { name, startMs, sinceLaunchMs() };
+        std::lock_guard<std::mutex> lock(mutex_);
+        phases_.push_back(phase);
+    }
+    void recordFirstFetch() { recordOnce(firstFetchMs_); }
+    void recordFirstWeather() { recordOnce(firstWeatherMs_); }
+
+    double firstFetchMs() const { return firstFetchMs_; }     // -1 until the first fetch starts
+    double firstWeatherMs() const { return firstWeatherMs_; } // -1 until weather first arrives
+    std::vector<Phase> phases() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return phases_;
+    }
+    std::string report() const;
+
+private:
+    void recordOnce(std::atomic<double>& milestone) {
+        double unset = -1.0;
+        milestone.compare_exchange_strong(unset, sinceLaunchMs());
+    }
+
+    const std::chrono::steady_clock::time_point launch_;
+    std::atomic<double> firstFetchMs_;
+    std::atomic<double> firstWeatherMs_;
+    mutable std::mutex mutex_;
+    std::vector<Phase> phases_;
+};
+
+// Viewport Hint: The cities whose rows are on screen in the City Selection list. The UI
+// updates it when the rows in view change; the fetch path reads it to send and parse those
+// cities' requests ahead of off-screen ones.
+class ViewportHint {
+public:
+    // Function to Replace the Visible Set; true if it changed
+    bool update(std::vector<CityHandle> cities) {
+        std::sort(cities.begin(), cities.end());
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cities == cities_) {
+            return false;
+        }
+        cities_.swap(cities);
+        return true;
+    }
+    bool contains(CityHandle city) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::binary_search(cities_.begin(), cities_.end(), city);
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<CityHandle> cities_; // Sorted
+};
+
+// In-Flight Requests Shared by Callers Asking for the Same Location or City Name
+extern SingleFlight<CityWeather> weatherFlights;
+extern SingleFlight<GeoLookup> geocodeFlights;
+
+// Finished Fetches Waiting for the UI Thread
+extern MpscQueue<WeatherResult> weatherResults;
 
 // Global Variables for Threading
-extern std::mutex weatherDataMutex;
-extern std::atomic<int> threadsFinished;
+extern WorkerPool fetchWorkers;
+extern TaskScheduler weatherTasks;
+extern FetchProgress fetchProgress;
+extern TransferStats transferStats;
+extern RevalidationStats revalidationStats;
+extern ViewportHint viewportHint;
+extern StartupTimings startupTimings;
+extern ResultApplyStats resultApplyStats;
 
 // Function Prototypes
 std::string readApiKeyFromFile(const std::string& filePath);
-void fetchWeatherDataForCity(City& city);
+FetchCycle fetchWeatherDataForCities(const std::vector<CityHandle>& selected);
+void cancelFetchCycle();
+void refreshWeatherForCities(const std::vector<CityHandle>& due, RequestPriority priority);
+void runDueRefreshes();
+size_t applyWeatherResults();
+void shutdownFetching();
+void startNetworkWarmUp();
+AsyncHttpClient& asyncClient(AsyncTransport transport);
 bool validateCity(const std::string& cityName, double& lon, double& lat);
-void loadFavorites(std::vector<City>& cities, std::set<std::string>& favorites);
+void loadFavorites(CityStore& cities, std::set<std::string>& favorites);
 void saveFavorites(const std::set<std::string>& favorites);
-void addFavorites(const std::vector<City>& cities, std::set<std::string>& favorites);
-void removeFavorites(const std::vector<City>& cities, std::set<std::string>& favorites);
-std::vector<City> filterFavorites(const std::vector<City>& cities, const std::set<std::string>& favorites);
+void addFavorites(CityStore& cities, std::set<std::string>& favorites);
+void removeFavorites(CityStore& cities, std::set<std::string>& favorites);
+void removeCities(CityStore& cities, std::set<std::string>& favorites);
+std::vector<CityIndex> filterFavorites(const CityStore& cities);
 std::string unixToHHMM(int unixTime);
-void uncheckAllCities(std::vector<City>& cities);
-bool markCity(const std::string& cityName, std::vector<City>& cities);
+void uncheckAllCities(CityStore& cities);
+bool markCity(const std::string& cityName, CityStore& cities);
 
 #endif // WEATHERFORECAST_H
@@ -0,0 +1,55 @@
+// WorkerPool.h
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker Pool: A fixed set of threads that execute jobs from a shared FIFO queue, so the
+// number of OS threads stays constant no matter how many cities are fetched at once. Urgent
+// jobs (e.g. for cities on screen) have their own FIFO queue that workers drain first.
+// A job that never gets to run, because the pool shut down first, runs its dropped handler
+// instead, so whoever waits on the job's result still hears back.
+class WorkerPool {
+public:
+    // A thread count of 0 sizes the pool from std::thread::hardware_concurrency().
+    explicit WorkerPool(size_t threadCount = 0);
+    ~WorkerPool();
+
+    void submit(std::function<void()> job, bool urgent = false, std::function<void()> dropped = std::function<void()>());
+    void waitIdle();
+    void shutdown();
+
+    size_t threadCount() const { return workers_.size(); }
+    size_t pending() const;
+
+    static size_t defaultThreadCount();
+
+private:
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    struct Job {
+        std::function<void()> run;
+        std::function<void()> dropped;
+    };
+
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<Job> urgentJobs_;
+    std::deque<Job> jobs_;
+    mutable std::mutex mutex_;
+    std::condition_variable jobAvailable_;
+    std::condition_variable idle_;
+    size_t running_;
+    bool stopping_;
+};
+
+#endif // WORKERPOOL_H
@@ -4,6 +4,11 @@
 //  Copyright (c) 2024 Yuji Hirose. All rights reserved.
 //  MIT License
 //
+//  Local patches to upstream 0.16.0 (re-apply when updating):
+//  - ClientImpl::process_request: a 304 response is read without a body, as
+//    RFC 9112 6.3 requires. Upstream 0.16.0 only exempts 204 there, so a 304
+//    without Content-Length was read until the server closed the connection.
+//
 
 #ifndef CPPHTTPLIB_HTTPLIB_H
 #define CPPHTTPLIB_HTTPLIB_H
@@ -7622,7 +7627,9 @@ inline bool ClientImpl::process_request(Stream &strm, Request &req,
   }
 
   // Body
-  if ((res.status != StatusCode::NoContent_204) && req.method != "HEAD" &&
+  // A 304 never carries a body (RFC 9110 15.4.5), even without Content-Length.
+  if ((res.status != StatusCode::NoContent_204) &&
+      (res.status != StatusCode::NotModified_304) && req.method != "HEAD" &&
       req.method != "CONNECT") {
     auto redirect = 300 < res.status && res.status < 400 && follow_location_;
 
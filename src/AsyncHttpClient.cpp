@@ -0,0 +1,1082 @@
+// AsyncHttpClient.cpp
+
+#include "AsyncHttpClient.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+#endif
+
+namespace {
+
+const size_t kMaxLineLength = 64 * 1024;
+const size_t kReadBufferSize = 16 * 1024;
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+// Splits "http://host:port" into host and port; only plain HTTP is supported.
+void parseSchemeHostPort(const std::string& schemeHostPort, std::string& host, int& port) {
+    std::string rest = schemeHostPort;
+    port = 80;
+    size_t scheme = rest.find("://");
+    if (scheme != std::string::npos) {
+        rest = rest.substr(scheme + 3);
+    }
+    size_t slash = rest.find('/');
+    if (slash != std::string::npos) {
+        rest = rest.substr(0, slash);
+    }
+    size_t colon = rest.rfind(':');
+    if (colon != std::string::npos) {
+        port = std::atoi(rest.c_str() + colon + 1);
+        rest = rest.substr(0, colon);
+    }
+    host = rest;
+}
+
+} // namespace
+
+HttpResponseParser::HttpResponseParser() {
+    reset();
+}
+
+void HttpResponseParser::reset() {
+    state_ = StatusLine;
+    response_ = httplib::Response();
+    line_.clear();
+    remaining_ = 0;
+    wireBodyBytes_ = 0;
+    decodedBodyBytes_ = 0;
+    decoder_.reset();
+    receiver_ = BodyReceiver();
+    sink_ = DecodedSink();
+    untilClose_ = false;
+    keepAlive_ = true;
+    started_ = false;
+}
+
+// Function to Consume Response Bytes; Returns How Many Bytes Belonged to This Response
+size_t HttpResponseParser::feed(const char* data, size_t size) {
+    size_t pos = 0;
+    if (size > 0) {
+        started_ = true;
+    }
+    while (pos < size && state_ != Complete && state_ != Error) {
+        if (state_ == Body || state_ == ChunkData) {
+            size_t count = size - pos;
+            if (!untilClose_ || state_ == ChunkData) {
+                count = std::min(count, remaining_);
+                remaining_ -= count;
+            }
+            appendBody(data + pos, count);
+            pos += count;
+            if (state_ == Error) {
+                break;
+            }
+            if (remaining_ == 0 && !(state_ == Body && untilClose_)) {
+                state_ = state_ == Body ? Complete : ChunkDataEnd;
+            }
+            continue;
+        }
+
+        const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+        size_t end = newline ? static_cast<size_t>(newline - data) + 1 : size;
+        line_.append(data + pos, end - pos);
+        pos = end;
+        if (!newline) {
+            if (line_.size() > kMaxLineLength) {
+                state_ = Error;
+            }
+            continue;
+        }
+
+        std::string line;
+        line.swap(line_);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+            line.pop_back();
+        }
+        processLine(line);
+    }
+    return pos;
+}
+
+bool HttpResponseParser::finishOnEof() {
+    if (state_ == Body && untilClose_) {
+        state_ = Complete;
+    }
+    return state_ == Complete;
+}
+
+void HttpResponseParser::processLine(const std::string& line) {
+    switch (state_) {
+    case StatusLine: {
+        // "HTTP/1.1 200 OK"
+        size_t space = line.find(' ');
+        if (line.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) {
+            state_ = Error;
+            return;
+        }
+        response_.version = line.substr(0, space);
+        response_.status = std::atoi(line.c_str() + space + 1);
+        size_t reason = line.find(' ', space + 1);
+        response_.reason = reason == std::string::npos ? std::string() : line.substr(reason + 1);
+        keepAlive_ = response_.version != "HTTP/1.0";
+        state_ = Headers;
+        break;
+    }
+    case Headers: {
+        if (line.empty()) {
+            beginBody();
+            return;
+        }
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            state_ = Error;
+            return;
+        }
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        std::string name = line.substr(0, colon);
+        if (toLower(name) == "connection") {
+            std::string lowered = toLower(value);
+            if (lowered.find("close") != std::string::npos) {
+                keepAlive_ = false;
+            }
+            else if (lowered.find("keep-alive") != std::string::npos) {
+                keepAlive_ = true;
+            }
+        }
+        response_.headers.emplace(name, value);
+        break;
+    }
+    case ChunkSize: {
+        char* end = nullptr;
+        unsigned long long chunk = std::strtoull(line.c_str(), &end, 16);
+        if (end == line.c_str()) {
+            state_ = Error;
+            return;
+        }
+        remaining_ = static_cast<size_t>(chunk);
+        state_ = chunk == 0 ? Trailers : ChunkData;
+        break;
+    }
+    case ChunkDataEnd:
+        state_ = line.empty() ? ChunkSize : Error;
+        break;
+    case Trailers:
+        if (line.empty()) {
+            state_ = Complete;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void HttpResponseParser::beginBody() {
+    int status = response_.status;
+    if (status >= 100 && status < 200) {
+        // Interim response (e.g. 100 Continue): the real status line follows.
+        response_ = httplib::Response();
+        state_ = StatusLine;
+        return;
+    }
+    if (status == 204 || status == 304) {
+        state_ = Complete;
+        return;
+    }
+    if (isGzipEncoding(response_.get_header_value("Content-Encoding")) && GzipDecoder::available()) {
+        decoder_.reset(new GzipDecoder());
+    }
+    if (receiver_) {
+        sink_ = receiver_(response_);
+    }
+    if (toLower(response_.get_header_value("Transfer-Encoding")).find("chunked") != std::string::npos) {
+        state_ = ChunkSize;
+        return;
+    }
+    if (response_.has_header("Content-Length")) {
+        remaining_ = static_cast<size_t>(std::strtoull(response_.get_header_value("Content-Length").c_str(), nullptr, 10));
+        if (!decoder_ && !sink_) {
+            response_.body.reserve(remaining_);
+        }
+        state_ = remaining_ == 0 ? Complete : Body;
+        return;
+    }
+    untilClose_ = true;
+    keepAlive_ = false;
+    state_ = Body;
+}
+
+void HttpResponseParser::appendBody(const char* data, size_t size) {
+    wireBodyBytes_ += size;
+    DecodedSink deliver = [this](const char* out, size_t length) {
+        decodedBodyBytes_ += length;
+        if (sink_) {
+            return sink_(out, length);
+        }
+        response_.body.append(out, length);
+        return true;
+    };
+    bool delivered = decoder_ ? decoder_->feed(data, size, deliver) : deliver(data, size);
+    if (!delivered) {
+        state_ = Error;
+    }
+}
+
+#ifdef __linux__
+
+namespace {
+
+struct PendingRequest {
+    std::string path;
+    httplib::Headers headers;
+    AsyncCallback callback;
+    BodyReceiver receiver;
+    std::chrono::steady_clock::time_point deadline; // Runs from submission, across queueing and retries
+    int attempts;
+};
+
+struct Connection {
+    enum State { Connecting, Sending, Receiving, Idle };
+
+    int fd;
+    State state;
+    bool closing; // Aborted while an operation was still queued in the kernel
+    std::string out;
+    size_t outOffset;
+    HttpResponseParser parser;
+    PendingRequest request;
+    std::chrono::steady_clock::time_point deadline;
+    std::vector<char> buffer; // Receive buffer owned by the connection (io_uring only)
+};
+
+} // namespace
+
+// Event Loop: Owns the connections of one loop thread and the request bookkeeping shared by
+// both transports. Requests from other threads arrive through incoming_ and an eventfd.
+struct AsyncHttpClient::Loop {
+    Loop(AsyncHttpClient* owner, size_t maxConnections);
+    virtual ~Loop();
+
+    void submit(PendingRequest request);
+    void stop();
+
+protected:
+    virtual void run() = 0;
+    virtual Connection* openConnection() = 0;
+    virtual void beginRequest(Connection* conn) = 0;
+    virtual void parkConnection(Connection* conn) = 0;
+    virtual void abortConnection(Connection* conn) = 0;
+
+    void startThread();
+    bool resolveAddress();
+    void takeIncoming();
+    void dispatch();
+    Connection* newConnection(int fd);
+    bool receive(Connection* conn, const char* data, size_t size);
+    void receiveEof(Connection* conn);
+    void complete(Connection* conn);
+    void fail(Connection* conn);
+    void closeConnection(Connection* conn);
+    void sweepTimeouts();
+    void failPending();
+
+    AsyncHttpClient* owner_;
+    size_t maxConnections_;
+    sockaddr_storage address_;  // Where new connections go; 0 length until resolved
+    socklen_t addressLength_;
+    std::string addressText_;   // The numeric address address_ was built from
+    bool addressFailed_;        // A connect failed since the address was last resolved
+    int wakeFd_;
+    std::thread thread_;
+
+    std::mutex mutex_;
+    std::deque<PendingRequest> incoming_;
+    std::atomic<bool> stopping_;
+
+    std::deque<PendingRequest> waiting_;
+    std::vector<Connection*> idle_;
+    std::vector<Connection*> connections_;
+};
+
+AsyncHttpClient::Loop::Loop(AsyncHttpClient* owner, size_t maxConnections)
+    : owner_(owner), maxConnections_(maxConnections), addressLength_(0), addressFailed_(false),
+      wakeFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), stopping_(false) {
+    std::memset(&address_, 0, sizeof(address_));
+}
+
+AsyncHttpClient::Loop::~Loop() {
+    stop();
+    for (Connection* conn : connections_) {
+        ::close(conn->fd);
+        delete conn;
+    }
+    ::close(wakeFd_);
+}
+
+void AsyncHttpClient::Loop::submit(PendingRequest request) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        incoming_.push_back(std::move(request));
+    }
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+    (void)written;
+}
+
+void AsyncHttpClient::Loop::stop() {
+    stopping_ = true;
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+    (void)written;
+    if (thread_.joinable()) {
+        thread_.join();
+        failPending();
+    }
+}
+
+// Function to Fail Every Request the Stopped Loop Still Held, Queued or on a Connection, so
+// no caller waits for a callback that would never come
+void AsyncHttpClient::Loop::failPending() {
+    std::deque<PendingRequest> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending.swap(incoming_);
+    }
+    for (PendingRequest& request : waiting_) {
+        pending.push_back(std::move(request));
+    }
+    waiting_.clear();
+    for (Connection* conn : connections_) {
+        if (conn->state != Connection::Idle && !conn->closing && conn->request.callback) {
+            pending.push_back(std::move(conn->request));
+            conn->request.callback = AsyncCallback();
+        }
+    }
+    for (PendingRequest& request : pending) {
+        request.callback(nullptr);
+        owner_->finishRequest();
+    }
+}
+
+// Called at the end of the derived constructor, once run() can be dispatched virtually.
+void AsyncHttpClient::Loop::startThread() {
+    thread_ = std::thread(&Loop::run, this);
+}
+
+// Function to Point New Connections at the Host's Current Address: the resolver's cached
+// answer, which it looks up again once its time to live runs out or after a connect failed.
+// Without a resolver the host is looked up directly, at first and again after a failure.
+bool AsyncHttpClient::Loop::resolveAddress() {
+    HostResolver* resolver = owner_->resolver_;
+    if (addressFailed_) {
+        addressFailed_ = false;
+        addressLength_ = 0;
+        if (resolver) {
+            resolver->expire(owner_->host_);
+        }
+    }
+    std::string host = owner_->host_;
+    if (resolver) {
+        host = resolver->resolve(owner_->host_);
+        if (host.empty()) {
+            return false;
+        }
+    }
+    if (addressLength_ != 0 && (!resolver || host == addressText_)) {
+        return true;
+    }
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = resolver ? AI_NUMERICHOST : 0; // The resolver's answer needs no lookup
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(owner_->port_).c_str(), &hints, &result) != 0 || !result) {
+        return false;
+    }
+    std::memcpy(&address_, result->ai_addr, result->ai_addrlen);
+    addressLength_ = result->ai_addrlen;
+    addressText_ = host;
+    freeaddrinfo(result);
+    return true;
+}
+
+void AsyncHttpClient::Loop::takeIncoming() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!incoming_.empty()) {
+        waiting_.push_back(std::move(incoming_.front()));
+        incoming_.pop_front();
+    }
+}
+
+// Function to Hand Waiting Requests to Idle Connections or Open New Ones Up to the Limit
+void AsyncHttpClient::Loop::dispatch() {
+    while (!waiting_.empty()) {
+        Connection* conn = nullptr;
+        if (!idle_.empty()) {
+            conn = idle_.back();
+            idle_.pop_back();
+        }
+        else if (connections_.size() < maxConnections_) {
+            conn = openConnection();
+            if (!conn) {
+                PendingRequest request = std::move(waiting_.front());
+                waiting_.pop_front();
+                request.callback(nullptr);
+                owner_->finishRequest();
+                continue;
+            }
+        }
+        else {
+            return;
+        }
+
+        PendingRequest request = std::move(waiting_.front());
+        waiting_.pop_front();
+        conn->out = "GET " + httplib::detail::encode_url(request.path) + " HTTP/1.1\r\nHost: " + owner_->host_;
+        if (owner_->port_ != 80) {
+            conn->out += ":" + std::to_string(owner_->port_);
+        }
+        conn->out += "\r\nAccept: */*\r\nConnection: keep-alive\r\n";
+        for (const auto& header : request.headers) {
+            conn->out += header.first + ": " + header.second + "\r\n";
+        }
+        conn->out += "\r\n";
+        conn->outOffset = 0;
+        conn->parser.reset();
+        conn->parser.setReceiver(request.receiver);
+        conn->deadline = request.deadline;
+        conn->request = std::move(request);
+        beginRequest(conn);
+    }
+}
+
+Connection* AsyncHttpClient::Loop::newConnection(int fd) {
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    Connection* conn = new Connection();
+    conn->fd = fd;
+    conn->state = Connection::Connecting;
+    conn->closing = false;
+    conn->outOffset = 0;
+    connections_.push_back(conn);
+    return conn;
+}
+
+// Feeds received bytes to the parser and finishes the request once the response is complete.
+// Returns true while more of the response is expected on this connection.
+bool AsyncHttpClient::Loop::receive(Connection* conn, const char* data, size_t size) {
+    conn->parser.feed(data, size);
+    if (conn->parser.failed()) {
+        fail(conn);
+        return false;
+    }
+    if (conn->parser.complete()) {
+        complete(conn);
+        return false;
+    }
+    return true;
+}
+
+void AsyncHttpClient::Loop::receiveEof(Connection* conn) {
+    if (conn->parser.finishOnEof()) {
+        complete(conn);
+    }
+    else {
+        fail(conn);
+    }
+}
+
+void AsyncHttpClient::Loop::complete(Connection* conn) {
+    PendingRequest request = std::move(conn->request);
+    bool keepAlive = conn->parser.keepAlive();
+    if (owner_->transferObserver_) {
+        owner_->transferObserver_(conn->parser.wireBodyBytes(), conn->parser.decodedBodyBytes());
+    }
+    request.callback(&conn->parser.response());
+    conn->parser.reset();
+    if (keepAlive && !stopping_) {
+        conn->state = Connection::Idle;
+        parkConnection(conn);
+        idle_.push_back(conn);
+    }
+    else {
+        closeConnection(conn);
+    }
+    owner_->finishRequest();
+}
+
+// A socket that fails before any response byte arrived was usually closed by the server
+// (a parked keep-alive connection timing out, or an overloaded server shedding a new one).
+// GET is idempotent, so such a request is retried once on a fresh connection. A failed
+// connect may mean the host moved, so the retry resolves the host again first.
+void AsyncHttpClient::Loop::fail(Connection* conn) {
+    if (conn->state == Connection::Connecting) {
+        addressFailed_ = true;
+    }
+    PendingRequest request = std::move(conn->request);
+    bool retry = !conn->parser.started() && request.attempts == 0 && !stopping_;
+    closeConnection(conn);
+    if (retry) {
+        request.attempts++;
+        waiting_.push_front(std::move(request));
+        return;
+    }
+    request.callback(nullptr);
+    owner_->finishRequest();
+}
+
+// Closing the descriptor also removes it from the epoll interest list.
+void AsyncHttpClient::Loop::closeConnection(Connection* conn) {
+    ::close(conn->fd);
+    connections_.erase(std::remove(connections_.begin(), connections_.end(), conn), connections_.end());
+    idle_.erase(std::remove(idle_.begin(), idle_.end(), conn), idle_.end());
+    delete conn;
+}
+
+// Requests still waiting for a connection expire too, so a saturated loop cannot hold one
+// past its deadline.
+void AsyncHttpClient::Loop::sweepTimeouts() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = waiting_.begin(); it != waiting_.end();) {
+        if (now > it->deadline) {
+            PendingRequest request = std::move(*it);
+            it = waiting_.erase(it);
+            request.callback(nullptr);
+            owner_->finishRequest();
+        }
+        else {
+            ++it;
+        }
+    }
+    std::vector<Connection*> expired;
+    for (Connection* conn : connections_) {
+        if (conn->state != Connection::Idle && !conn->closing && now > conn->deadline) {
+            expired.push_back(conn);
+        }
+    }
+    for (Connection* conn : expired) {
+        PendingRequest request = std::move(conn->request);
+        abortConnection(conn);
+        request.callback(nullptr);
+        owner_->finishRequest();
+    }
+}
+
+// Epoll Loop: Readiness-based transport; non-blocking sockets are written and read with
+// plain send/recv calls when epoll reports them ready.
+struct AsyncHttpClient::EpollLoop : AsyncHttpClient::Loop {
+    EpollLoop(AsyncHttpClient* owner, size_t maxConnections);
+    ~EpollLoop();
+
+protected:
+    void run();
+    Connection* openConnection();
+    void beginRequest(Connection* conn);
+    void parkConnection(Connection* conn);
+    void abortConnection(Connection* conn);
+
+private:
+    void handle(Connection* conn, uint32_t events);
+    int flush(Connection* conn);
+    void drain(Connection* conn);
+    void watch(Connection* conn, uint32_t events);
+
+    int epollFd_;
+    std::vector<char> buffer_;
+};
+
+AsyncHttpClient::EpollLoop::EpollLoop(AsyncHttpClient* owner, size_t maxConnections)
+    : Loop(owner, maxConnections), epollFd_(epoll_create1(EPOLL_CLOEXEC)), buffer_(kReadBufferSize) {
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr; // nullptr marks the wake-up eventfd
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+    startThread();
+}
+
+AsyncHttpClient::EpollLoop::~EpollLoop() {
+    stop();
+    ::close(epollFd_);
+}
+
+void AsyncHttpClient::EpollLoop::run() {
+    epoll_event events[256];
+    while (!stopping_) {
+        takeIncoming();
+        dispatch();
+
+        int count = epoll_wait(epollFd_, events, 256, 100);
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                uint64_t value;
+                ssize_t readBytes = ::read(wakeFd_, &value, sizeof(value));
+                (void)readBytes;
+                continue;
+            }
+            handle(static_cast<Connection*>(events[i].data.ptr), events[i].events);
+        }
+        sweepTimeouts();
+    }
+}
+
+Connection* AsyncHttpClient::EpollLoop::openConnection() {
+    if (!resolveAddress()) {
+        return nullptr;
+    }
+    int fd = ::socket(address_.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address_), addressLength_) < 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        addressFailed_ = true;
+        return nullptr;
+    }
+    Connection* conn = newConnection(fd);
+    epoll_event ev;
+    ev.events = EPOLLOUT; // Writable once the connect has finished
+    ev.data.ptr = conn;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+    return conn;
+}
+
+void AsyncHttpClient::EpollLoop::beginRequest(Connection* conn) {
+    if (conn->state != Connection::Idle) {
+        return; // Still connecting: the request goes out when EPOLLOUT fires
+    }
+    conn->state = Connection::Sending;
+    int sent = flush(conn);
+    if (sent > 0) {
+        watch(conn, EPOLLIN | EPOLLRDHUP);
+    }
+    else if (sent == 0) {
+        watch(conn, EPOLLOUT);
+    }
+}
+
+// Parked connections stay registered for input so a server-side close is noticed.
+void AsyncHttpClient::EpollLoop::parkConnection(Connection* conn) {
+    watch(conn, EPOLLIN | EPOLLRDHUP);
+}
+
+void AsyncHttpClient::EpollLoop::abortConnection(Connection* conn) {
+    closeConnection(conn);
+}
+
+void AsyncHttpClient::EpollLoop::handle(Connection* conn, uint32_t events) {
+    if (conn->state == Connection::Idle) {
+        // The server closed (or wrote to) a parked keep-alive connection.
+        closeConnection(conn);
+        return;
+    }
+    if (conn->state == Connection::Connecting) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0 || (events & (EPOLLERR | EPOLLHUP))) {
+            fail(conn);
+            return;
+        }
+        conn->state = Connection::Sending;
+    }
+    if (conn->state == Connection::Sending) {
+        if (flush(conn) > 0) {
+            watch(conn, EPOLLIN | EPOLLRDHUP);
+        }
+        return;
+    }
+    drain(conn);
+}
+
+// Writes as much of the request as the socket accepts. Returns 1 once everything has been
+// sent, 0 if the socket is full, and -1 if the connection failed (and has been released).
+int AsyncHttpClient::EpollLoop::flush(Connection* conn) {
+    while (conn->outOffset < conn->out.size()) {
+        ssize_t written = ::send(conn->fd, conn->out.data() + conn->outOffset, conn->out.size() - conn->outOffset, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            fail(conn);
+            return -1;
+        }
+        conn->outOffset += static_cast<size_t>(written);
+    }
+    conn->state = Connection::Receiving;
+    return 1;
+}
+
+// Reads until the socket would block or the response is complete.
+void AsyncHttpClient::EpollLoop::drain(Connection* conn) {
+    for (;;) {
+        ssize_t received = ::recv(conn->fd, buffer_.data(), buffer_.size(), 0);
+        if (received > 0) {
+            if (!receive(conn, buffer_.data(), static_cast<size_t>(received))) {
+                return;
+            }
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (received == 0) {
+            receiveEof(conn);
+        }
+        else {
+            fail(conn);
+        }
+        return;
+    }
+}
+
+void AsyncHttpClient::EpollLoop::watch(Connection* conn, uint32_t events) {
+    epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = conn;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+#ifdef HAVE_LIBURING
+
+// Uring Loop: Completion-based transport. Connects, sends and receives for every in-flight
+// request are queued as submission entries and handed to the kernel with one
+// io_uring_submit() per loop iteration, instead of one syscall per socket operation.
+struct AsyncHttpClient::UringLoop : AsyncHttpClient::Loop {
+    UringLoop(AsyncHttpClient* owner, size_t maxConnections);
+    ~UringLoop();
+
+    bool ready() const { return ready_; }
+
+protected:
+    void run();
+    Connection* openConnection();
+    void beginRequest(Connection* conn);
+    void parkConnection(Connection* conn);
+    void abortConnection(Connection* conn);
+
+private:
+    io_uring_sqe* nextSqe();
+    void armWake();
+    void queueConnect(Connection* conn);
+    void queueSend(Connection* conn);
+    void queueRecv(Connection* conn);
+    void handle(Connection* conn, int result);
+
+    io_uring ring_;
+    bool ready_;
+    uint64_t wakeValue_;
+};
+
+AsyncHttpClient::UringLoop::UringLoop(AsyncHttpClient* owner, size_t maxConnections)
+    : Loop(owner, maxConnections), ready_(false), wakeValue_(0) {
+    // Each connection has at most one operation queued, plus the eventfd read.
+    unsigned entries = 64;
+    while (entries < maxConnections + 1 && entries < 4096) {
+        entries *= 2;
+    }
+    ready_ = io_uring_queue_init(entries, &ring_, 0) == 0;
+    if (ready_) {
+        startThread();
+    }
+}
+
+AsyncHttpClient::UringLoop::~UringLoop() {
+    stop();
+    if (ready_) {
+        io_uring_queue_exit(&ring_);
+    }
+}
+
+void AsyncHttpClient::UringLoop::run() {
+    armWake();
+    while (!stopping_) {
+        takeIncoming();
+        dispatch();
+        io_uring_submit(&ring_);
+
+        io_uring_cqe* cqe = nullptr;
+        __kernel_timespec timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_nsec = 100 * 1000 * 1000;
+        io_uring_wait_cqe_timeout(&ring_, &cqe, &timeout);
+        while (io_uring_peek_cqe(&ring_, &cqe) == 0) {
+            Connection* conn = static_cast<Connection*>(io_uring_cqe_get_data(cqe));
+            int result = cqe->res;
+            io_uring_cqe_seen(&ring_, cqe);
+            if (conn == nullptr) {
+                armWake();
+                continue;
+            }
+            handle(conn, result);
+        }
+        sweepTimeouts();
+    }
+}
+
+Connection* AsyncHttpClient::UringLoop::openConnection() {
+    if (!resolveAddress()) {
+        return nullptr;
+    }
+    int fd = ::socket(address_.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    Connection* conn = newConnection(fd);
+    conn->buffer.resize(kReadBufferSize / 2);
+    return conn;
+}
+
+void AsyncHttpClient::UringLoop::beginRequest(Connection* conn) {
+    if (conn->state == Connection::Connecting) {
+        queueConnect(conn);
+        return;
+    }
+    conn->state = Connection::Sending;
+    queueSend(conn);
+}
+
+// Parked connections have nothing queued; a server-side close shows up as a failed send or
+// an empty read on reuse, which fail() retries on a fresh connection.
+void AsyncHttpClient::UringLoop::parkConnection(Connection*) {
+}
+
+// The queued operation still references the connection, so it is only shut down here and
+// released when its completion arrives.
+void AsyncHttpClient::UringLoop::abortConnection(Connection* conn) {
+    conn->closing = true;
+    ::shutdown(conn->fd, SHUT_RDWR);
+}
+
+io_uring_sqe* AsyncHttpClient::UringLoop::nextSqe() {
+    io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    if (!sqe) {
+        io_uring_submit(&ring_); // Submission queue full: flush it and try again
+        sqe = io_uring_get_sqe(&ring_);
+    }
+    return sqe;
+}
+
+void AsyncHttpClient::UringLoop::armWake() {
+    io_uring_sqe* sqe = nextSqe();
+    if (sqe) {
+        io_uring_prep_read(sqe, wakeFd_, &wakeValue_, sizeof(wakeValue_), 0);
+        io_uring_sqe_set_data(sqe, nullptr);
+    }
+}
+
+void AsyncHttpClient::UringLoop::queueConnect(Connection* conn) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        fail(conn);
+        return;
+    }
+    io_uring_prep_connect(sqe, conn->fd, reinterpret_cast<const sockaddr*>(&address_), addressLength_);
+    io_uring_sqe_set_data(sqe, conn);
+}
+
+void AsyncHttpClient::UringLoop::queueSend(Connection* conn) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        fail(conn);
+        return;
+    }
+    io_uring_prep_send(sqe, conn->fd, conn->out.data() + conn->outOffset, conn->out.size() - conn->outOffset, MSG_NOSIGNAL);
+    io_uring_sqe_set_data(sqe, conn);
+}
+
+void AsyncHttpClient::UringLoop::queueRecv(Connection* conn) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        fail(conn);
+        return;
+    }
+    io_uring_prep_recv(sqe, conn->fd, conn->buffer.data(), conn->buffer.size(), 0);
+    io_uring_sqe_set_data(sqe, conn);
+}
+
+void AsyncHttpClient::UringLoop::handle(Connection* conn, int result) {
+    if (conn->closing) {
+        closeConnection(conn); // Completion of an aborted operation
+        return;
+    }
+    if (result < 0) {
+        fail(conn);
+        return;
+    }
+    switch (conn->state) {
+    case Connection::Connecting:
+        conn->state = Connection::Sending;
+        queueSend(conn);
+        break;
+    case Connection::Sending:
+        conn->outOffset += static_cast<size_t>(result);
+        if (conn->outOffset < conn->out.size()) {
+            queueSend(conn);
+        }
+        else {
+            conn->state = Connection::Receiving;
+            queueRecv(conn);
+        }
+        break;
+    case Connection::Receiving:
+        if (result == 0) {
+            receiveEof(conn);
+            break;
+        }
+        if (receive(conn, conn->buffer.data(), static_cast<size_t>(result))) {
+            queueRecv(conn);
+        }
+        break;
+    case Connection::Idle:
+        break;
+    }
+}
+
+#endif // HAVE_LIBURING
+
+// The host is resolved by each loop thread when it opens its first connection, not here.
+AsyncHttpClient::AsyncHttpClient(const std::string& schemeHostPort, AsyncTransport transport, size_t loopThreads, size_t maxConnections,
+    HostResolver* resolver)
+    : resolver_(resolver), transport_(supported(transport) ? transport : AsyncTransport::Epoll),
+      nextLoop_(0), inFlight_(0), requestTimeoutMs_(10000), stopped_(false) {
+    parseSchemeHostPort(schemeHostPort, host_, port_);
+
+    if (loopThreads == 0) {
+        loopThreads = 1;
+    }
+    size_t perLoop = std::max<size_t>(1, maxConnections / loopThreads);
+    for (size_t i = 0; i < loopThreads; ++i) {
+#ifdef HAVE_LIBURING
+        if (transport_ == AsyncTransport::IoUring) {
+            std::unique_ptr<UringLoop> loop(new UringLoop(this, perLoop));
+            if (loop->ready()) {
+                loops_.push_back(std::move(loop));
+                continue;
+            }
+            transport_ = AsyncTransport::Epoll; // The ring could not be created (e.g. memlock limit)
+        }
+#endif
+        loops_.emplace_back(new EpollLoop(this, perLoop));
+    }
+}
+
+// Function to Check Whether a Transport Can Be Used; io_uring needs liburing at build time
+// and a kernel that supports the connect, send, recv and read operations.
+bool AsyncHttpClient::supported(AsyncTransport transport) {
+    if (transport == AsyncTransport::Epoll) {
+        return true;
+    }
+#ifdef HAVE_LIBURING
+    static const bool uringAvailable = [] {
+        io_uring ring;
+        if (io_uring_queue_init(4, &ring, 0) < 0) {
+            return false;
+        }
+        io_uring_probe* probe = io_uring_get_probe_ring(&ring);
+        bool available = probe &&
+            io_uring_opcode_supported(probe, IORING_OP_CONNECT) &&
+            io_uring_opcode_supported(probe, IORING_OP_SEND) &&
+            io_uring_opcode_supported(probe, IORING_OP_RECV) &&
+            io_uring_opcode_supported(probe, IORING_OP_READ);
+        if (probe) {
+            io_uring_free_probe(probe);
+        }
+        io_uring_queue_exit(&ring);
+        return available;
+    }();
+    return uringAvailable;
+#else
+    return false;
+#endif
+}
+
+#else // !__linux__
+
+struct AsyncHttpClient::Loop {
+};
+
+AsyncHttpClient::AsyncHttpClient(const std::string& schemeHostPort, AsyncTransport transport, size_t, size_t, HostResolver* resolver)
+    : resolver_(resolver), transport_(transport), nextLoop_(0), inFlight_(0), requestTimeoutMs_(10000), stopped_(false) {
+    parseSchemeHostPort(schemeHostPort, host_, port_);
+}
+
+bool AsyncHttpClient::supported(AsyncTransport) {
+    return false;
+}
+
+#endif // __linux__
+
+AsyncHttpClient::~AsyncHttpClient() {
+    shutdown();
+}
+
+// Function to Queue a GET Request; the Callback Runs on an Event-Loop Thread
+void AsyncHttpClient::get(const std::string& path, const httplib::Headers& headers, AsyncCallback callback,
+    std::chrono::milliseconds timeout, BodyReceiver receiver) {
+#ifdef __linux__
+    if (!stopped_ && !loops_.empty()) {
+        inFlight_++;
+        PendingRequest request;
+        request.path = path;
+        request.headers = headers;
+        request.callback = std::move(callback);
+        request.receiver = std::move(receiver);
+        long long timeoutMs = timeout.count() > 0 ? timeout.count() : requestTimeoutMs_.load();
+        request.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        request.attempts = 0;
+        loops_[nextLoop_++ % loops_.size()]->submit(std::move(request));
+        return;
+    }
+#else
+    (void)path;
+    (void)headers;
+    (void)timeout;
+    (void)receiver;
+#endif
+    callback(nullptr);
+}
+
+// Function to Block Until Every Submitted Request Has Completed or Failed
+void AsyncHttpClient::waitIdle() {
+    std::unique_lock<std::mutex> lock(idleMutex_);
+    idle_.wait(lock, [this] { return inFlight_ == 0; });
+}
+
+// Function to Stop the Event Loops; Requests Still in Flight Fail, Their Callbacks Running
+// With nullptr Before shutdown() Returns
+void AsyncHttpClient::shutdown() {
+    if (stopped_) {
+        return;
+    }
+    stopped_ = true;
+    loops_.clear();
+}
+
+void AsyncHttpClient::finishRequest() {
+    if (--inFlight_ == 0) {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        idle_.notify_all();
+    }
+}
@@ -0,0 +1,179 @@
+// CircuitBreaker.cpp
+
+#include "CircuitBreaker.h"
+
+#include <cstdio>
+
+namespace {
+
+const size_t kTransitionHistory = 16;
+
+} // namespace
+
+CircuitBreaker::CircuitBreaker(const std::string& name, const BreakerOptions& options, TransitionObserver observer)
+    : name_(name), options_(options), state_(BreakerState::Closed), windowFailures_(0),
+      probesSent_(0), probesSucceeded_(0), observer_(std::move(observer)),
+      allowed_(0), rejected_(0), failures_(0), slowCalls_(0), opened_(0) {
+}
+
+// Function to Ask Whether a Call May Go Out; moves an open breaker to half-open once its
+// open duration has passed, and hands out the half-open probes one call at a time
+bool CircuitBreaker::allow() {
+    std::vector<Transition> fired;
+    bool allowed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        if (state_ == BreakerState::Open && now - openedAt_ >= options_.openDuration) {
+            transitionLocked(BreakerState::HalfOpen, "open duration elapsed", fired);
+        }
+        allowed = !rejectingLocked(now);
+        if (allowed) {
+            allowed_++;
+            if (state_ == BreakerState::HalfOpen) {
+                probesSent_++;
+            }
+        }
+        else {
+            rejected_++;
+        }
+    }
+    notify(fired);
+    return allowed;
+}
+
+bool CircuitBreaker::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ == BreakerState::Open && std::chrono::steady_clock::now() - openedAt_ < options_.openDuration;
+}
+
+// Function to Record the Outcome of a Call That allow() Let Through
+void CircuitBreaker::record(bool success, double latencyMs) {
+    std::vector<Transition> fired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool slow = latencyMs > options_.slowCall.count();
+        bool failed = !success || slow;
+        if (slow) {
+            slowCalls_++;
+        }
+        if (failed) {
+            failures_++;
+        }
+
+        if (state_ == BreakerState::HalfOpen) {
+            if (failed) {
+                transitionLocked(BreakerState::Open, slow ? "probe too slow" : "probe failed", fired);
+            }
+            else if (++probesSucceeded_ >= options_.halfOpenProbes) {
+                transitionLocked(BreakerState::Closed, "probes succeeded", fired);
+            }
+        }
+        else if (state_ == BreakerState::Closed) {
+            outcomes_.push_back(failed);
+            windowFailures_ += failed ? 1 : 0;
+            if (outcomes_.size() > options_.window) {
+                windowFailures_ -= outcomes_.front() ? 1 : 0;
+                outcomes_.pop_front();
+            }
+            if (outcomes_.size() >= options_.minimumCalls &&
+                windowFailures_ >= options_.failureRatio * outcomes_.size()) {
+                char reason[64];
+                std::snprintf(reason, sizeof(reason), "%zu of %zu recent calls failed", windowFailures_, outcomes_.size());
+                transitionLocked(BreakerState::Open, reason, fired);
+            }
+        }
+        // Calls finishing while open were let through before it tripped and change nothing.
+    }
+    notify(fired);
+}
+
+// Function to Hand Back a Call That Was Cancelled Before It Was Sent; a half-open probe
+// slot is freed so another call can probe instead
+void CircuitBreaker::abandon() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == BreakerState::HalfOpen && probesSent_ > probesSucceeded_) {
+        probesSent_--;
+    }
+}
+
+BreakerState CircuitBreaker::state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+// Function to Read the Breaker Counters
+CircuitBreaker::Stats CircuitBreaker::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s;
+    s.state = state_;
+    s.allowed = allowed_;
+    s.rejected = rejected_;
+    s.failures = failures_;
+    s.slowCalls = slowCalls_;
+    s.opened = opened_;
+    s.failureRate = outcomes_.empty() ? 0.0 : static_cast<double>(windowFailures_) / outcomes_.size();
+    return s;
+}
+
+std::vector<CircuitBreaker::Transition> CircuitBreaker::transitions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<Transition>(transitions_.begin(), transitions_.end());
+}
+
+const char* CircuitBreaker::stateName(BreakerState state) {
+    switch (state) {
+    case BreakerState::Closed:
+        return "closed";
+    case BreakerState::Open:
+        return "open";
+    case BreakerState::HalfOpen:
+        return "half-open";
+    }
+    return "unknown";
+}
+
+// Every state starts clean: opening resets the probe counts, closing clears the window so old
+// failures cannot trip the breaker again straight away.
+void CircuitBreaker::transitionLocked(BreakerState to, const std::string& reason, std::vector<Transition>& fired) {
+    Transition transition = { state_, to, std::chrono::system_clock::now(), reason };
+    state_ = to;
+    if (to == BreakerState::Open) {
+        openedAt_ = std::chrono::steady_clock::now();
+        opened_++;
+    }
+    if (to != BreakerState::Closed) {
+        probesSent_ = 0;
+        probesSucceeded_ = 0;
+    }
+    else {
+        outcomes_.clear();
+        windowFailures_ = 0;
+    }
+
+    transitions_.push_back(transition);
+    if (transitions_.size() > kTransitionHistory) {
+        transitions_.pop_front();
+    }
+    fired.push_back(transition);
+}
+
+// The observer runs outside the lock so it may read the breaker's stats.
+void CircuitBreaker::notify(const std::vector<Transition>& fired) const {
+    if (!observer_) {
+        return;
+    }
+    for (const Transition& transition : fired) {
+        observer_(*this, transition);
+    }
+}
+
+bool CircuitBreaker::rejectingLocked(std::chrono::steady_clock::time_point now) const {
+    if (state_ == BreakerState::Open) {
+        return now - openedAt_ < options_.openDuration;
+    }
+    if (state_ == BreakerState::HalfOpen) {
+        return probesSent_ >= options_.halfOpenProbes;
+    }
+    return false;
+}
@@ -0,0 +1,255 @@
+// CityStore.cpp
+
+#include "CityStore.h"
+
+#include <algorithm>
+#include <bitset>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+void CityBitset::resize(size_t size) {
+    words_.resize((size + 63) / 64, 0);
+    if (size < size_ && size % 64 != 0) {
+        words_.back() &= (uint64_t(1) << (size % 64)) - 1; // Bits past the end stay clear
+    }
+    size_ = size;
+}
+
+void CityBitset::set(CityIndex i, bool value) {
+    uint64_t bit = uint64_t(1) << (i & 63);
+    if (value) {
+        words_[i >> 6] |= bit;
+    }
+    else {
+        words_[i >> 6] &= ~bit;
+    }
+}
+
+void CityBitset::clear() {
+    std::fill(words_.begin(), words_.end(), 0);
+}
+
+void CityBitset::fill() {
+    std::fill(words_.begin(), words_.end(), ~uint64_t(0));
+    if (size_ % 64 != 0) {
+        words_.back() = (uint64_t(1) << (size_ % 64)) - 1;
+    }
+}
+
+size_t CityBitset::count() const {
+    size_t total = 0;
+    for (uint64_t word : words_) {
+        total += std::bitset<64>(word).count();
+    }
+    return total;
+}
+
+bool CityBitset::any() const {
+    for (uint64_t word : words_) {
+        if (word != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<CityIndex> CityBitset::indices() const {
+    std::vector<CityIndex> set;
+    set.reserve(count());
+    forEach([&set](CityIndex i) { set.push_back(i); });
+    return set;
+}
+
+size_t CityBitset::lowestBit(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward64(&bit, word);
+    return bit;
+#else
+    return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+}
+
+uint32_t NameTable::intern(const std::string& name) {
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(names_.size());
+    names_.push_back(name);
+    ids_.emplace(name, id);
+    return id;
+}
+
+bool NameTable::find(const std::string& name, uint32_t& id) const {
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+void NameTable::clear() {
+    names_.clear();
+    ids_.clear();
+}
+
+const CityIndex CityStore::npos;
+const size_t CityStore::kCapacity;
+
+CityStore::CityStore(std::initializer_list<Entry> entries) : slots_(0), liveCount_(0) {
+    for (const Entry& entry : entries) {
+        add(entry.name, entry.lon, entry.lat);
+    }
+}
+
+CityStore::~CityStore() {
+    releaseWeather();
+}
+
+// Function to Put a City in a Free Slot, or a New One; it starts unselected, not a favorite
+// and without weather. A new slot is filled in before slots() counts it.
+CityHandle CityStore::add(const std::string& name, double lon, double lat) {
+    CityIndex index;
+    if (!freeSlots_.empty()) {
+        index = freeSlots_.back();
+        freeSlots_.pop_back();
+    }
+    else {
+        index = slots_.load(std::memory_order_relaxed);
+        if (index == kCapacity) {
+            return CityHandle();
+        }
+        reserve(index + 1);
+        generation_[index].store(1, std::memory_order_relaxed);
+    }
+    uint32_t nameId = names_.intern(name);
+    if (nameId == firstByName_.size()) {
+        firstByName_.push_back(npos);
+        lastByName_.push_back(npos);
+    }
+    previousByName_[index] = lastByName_[nameId];
+    nextByName_[index] = npos;
+    if (lastByName_[nameId] == npos) {
+        firstByName_[nameId] = index;
+    }
+    else {
+        nextByName_[lastByName_[nameId]] = index;
+    }
+    lastByName_[nameId] = index;
+    nameIds_[index] = nameId;
+    name_[index] = &names_.name(nameId);
+    lon_[index] = lon;
+    lat_[index] = lat;
+    clearWeather(index);
+    owmId_[index] = 0;
+    validators_[index] = CacheValidators();
+    live_.set(index, true);
+    liveCount_++;
+    if (index == slots_.load(std::memory_order_relaxed)) {
+        slots_.store(index + 1, std::memory_order_release);
+    }
+    return handle(index);
+}
+
+// Function to Remove a City; its slot moves to the next generation at once, so results still
+// in flight for it no longer resolve, and the slot is reused by a later add()
+bool CityStore::remove(CityHandle city) {
+    CityIndex index;
+    if (!resolve(city, index)) {
+        return false;
+    }
+    uint32_t generation = city.generation + 1;
+    generation_[index].store(generation == 0 ? 1 : generation, std::memory_order_release);
+    live_.set(index, false);
+    selected_.set(index, false);
+    favorite_.set(index, false);
+    liveCount_--;
+    freeSlots_.push_back(static_cast<uint32_t>(index));
+    uint32_t nameId = nameIds_[index];
+    CityIndex previous = previousByName_[index];
+    CityIndex next = nextByName_[index];
+    (previous == npos ? firstByName_[nameId] : nextByName_[previous]) = next;
+    (next == npos ? lastByName_[nameId] : previousByName_[next]) = previous;
+    return true;
+}
+
+bool CityStore::resolve(CityHandle city, CityIndex& i) const {
+    if (!city.valid() || city.slot >= slots() || generation_[city.slot].load(std::memory_order_acquire) != city.generation) {
+        return false;
+    }
+    i = city.slot;
+    return true;
+}
+
+CityIndex CityStore::find(const std::string& name) const {
+    uint32_t nameId;
+    return names_.find(name, nameId) ? firstByName_[nameId] : npos;
+}
+
+// Function to Remove Every City; published snapshots are retired like any replaced one, so
+// a reader still inside a ReadGuard keeps a valid snapshot
+void CityStore::clear() {
+    for (CityIndex i = 0; i < slots(); i++) {
+        publish(i, nullptr);
+    }
+    rcu_.collect();
+    slots_.store(0, std::memory_order_relaxed);
+    liveCount_ = 0;
+    freeSlots_.clear();
+    live_ = CityBitset();
+    names_.clear();
+    firstByName_.clear();
+    lastByName_.clear();
+    selected_ = CityBitset();
+    favorite_ = CityBitset();
+    generation_.clear();
+    nameIds_.clear();
+    name_.clear();
+    nextByName_.clear();
+    previousByName_.clear();
+    lon_.clear();
+    lat_.clear();
+    weather_.clear();
+    owmId_.clear();
+    validators_.clear();
+}
+
+// Function to Make Slots [0, size) Addressable in Every Column and Bitset
+void CityStore::reserve(size_t size) {
+    live_.resize(size);
+    selected_.resize(size);
+    favorite_.resize(size);
+    generation_.reserve(size);
+    nameIds_.reserve(size);
+    name_.reserve(size);
+    nextByName_.reserve(size);
+    previousByName_.reserve(size);
+    lon_.reserve(size);
+    lat_.reserve(size);
+    weather_.reserve(size);
+    owmId_.reserve(size);
+    validators_.reserve(size);
+}
+
+// Function to Publish a Copy of a City's Weather; the snapshot it replaces is retired, since
+// readers may still hold it
+void CityStore::setWeather(CityIndex i, const WeatherSnapshot& weather) {
+    publish(i, weather.empty() ? nullptr : new WeatherSnapshot(weather));
+}
+
+void CityStore::publish(CityIndex i, const WeatherSnapshot* weather) {
+    if (!weather && !weather_[i].load(std::memory_order_relaxed)) {
+        return;
+    }
+    rcu_.retire(weather_[i].exchange(weather, std::memory_order_seq_cst));
+}
+
+// Function to Delete Every Published Snapshot; only once no reader can reach the store
+void CityStore::releaseWeather() {
+    for (CityIndex i = 0; i < slots(); i++) {
+        delete weather_[i].exchange(nullptr, std::memory_order_relaxed);
+    }
+}
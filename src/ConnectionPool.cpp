@@ -0,0 +1,191 @@
+// ConnectionPool.cpp
+
+#include "ConnectionPool.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+ConnectionPool::Lease::Lease(ConnectionPool* pool, std::unique_ptr<httplib::Client> client)
+    : pool_(pool), client_(std::move(client)), reusable_(true) {
+}
+
+ConnectionPool::Lease::Lease(Lease&& other)
+    : pool_(other.pool_), client_(std::move(other.client_)), reusable_(other.reusable_) {
+    other.pool_ = nullptr;
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (pool_ && client_) {
+        pool_->release(std::move(client_), reusable_);
+    }
+}
+
+ConnectionPool::ConnectionPool(const std::string& host, size_t maxIdle, std::chrono::seconds idleTimeout,
+    HostResolver* resolver)
+    : host_(host), resolver_(resolver), maxIdle_(maxIdle), idleTimeout_(idleTimeout), stopped_(false),
+      acquired_(0), reused_(0), created_(0), evicted_(0), discarded_(0), warmed_(0) {
+    size_t start = host_.find("://");
+    start = start == std::string::npos ? 0 : start + 3;
+    size_t end = host_.find_first_of(":/", start);
+    hostname_ = host_.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+// Function to Borrow a Client, Preferring the Most Recently Used Idle One
+ConnectionPool::Lease ConnectionPool::acquire() {
+    std::unique_ptr<httplib::Client> client;
+    std::deque<IdleClient> evicted; // Closed after the lock is released
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        evictIdleLocked(std::chrono::steady_clock::now(), evicted);
+        if (!idle_.empty()) {
+            client = std::move(idle_.back().client);
+            idle_.pop_back();
+        }
+    }
+
+    acquired_++;
+    if (client) {
+        if (client->is_socket_open()) {
+            reused_++;
+        }
+    }
+    else {
+        client = createClient();
+        created_++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        leased_.insert(client.get());
+    }
+    return Lease(this, std::move(client));
+}
+
+// Function to Open Keep-Alive Connections Ahead of Demand, in Parallel. httplib has no bare
+// connect, so each connection is opened with a HEAD / that carries no API key and so costs
+// no quota. Returns how many connections ended up idle in the pool.
+size_t ConnectionPool::warmUp(size_t count, std::chrono::milliseconds timeout) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count = std::min(count, maxIdle_ > idle_.size() ? maxIdle_ - idle_.size() : 0);
+    }
+
+    std::atomic<size_t> opened(0);
+    std::vector<std::thread> openers;
+    for (size_t i = 0; i < count; ++i) {
+        openers.emplace_back([this, timeout, &opened] {
+            std::unique_ptr<httplib::Client> client = createClient();
+            client->set_connection_timeout(timeout);
+            client->set_read_timeout(timeout);
+            client->set_write_timeout(timeout);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                leased_.insert(client.get()); // Reachable by stopAll() while connecting
+            }
+            created_++;
+            bool open = client->Head("/") && client->is_socket_open();
+            if (open) {
+                opened++;
+                warmed_++;
+            }
+            release(std::move(client), open);
+        });
+    }
+    for (auto& opener : openers) {
+        opener.join();
+    }
+    return opened;
+}
+
+// Function to Change the Pool Size and Idle Timeout at Runtime; the clients it drops close
+// their sockets after the lock is released, so acquire() never waits on a socket shutdown
+void ConnectionPool::configure(size_t maxIdle, std::chrono::seconds idleTimeout) {
+    std::deque<IdleClient> dropped;
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxIdle_ = maxIdle;
+    idleTimeout_ = idleTimeout;
+    while (idle_.size() > maxIdle_) {
+        dropped.push_back(std::move(idle_.front()));
+        idle_.pop_front();
+        discarded_++;
+    }
+    evictIdleLocked(std::chrono::steady_clock::now(), dropped);
+}
+
+// Function to Close Connections That Have Been Idle Longer Than the Timeout
+void ConnectionPool::evictIdle() {
+    std::deque<IdleClient> evicted;
+    std::lock_guard<std::mutex> lock(mutex_);
+    evictIdleLocked(std::chrono::steady_clock::now(), evicted);
+}
+
+// Function to Abort Every Request on a Borrowed Client and Close the Idle Connections; used
+// at exit so blocked fetch workers return promptly instead of waiting out their timeouts.
+// stop() only reaches a socket that is already open, so a worker that borrows a client
+// afterwards, or has not connected yet, must check stopped() before sending.
+void ConnectionPool::stopAll() {
+    std::deque<IdleClient> idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        for (httplib::Client* client : leased_) {
+            client->stop(); // Shuts the socket down under the request; the Get() call then fails
+        }
+        idle.swap(idle_);
+    }
+    discarded_ += idle.size();
+}
+
+// Function to Read the Pool Counters
+ConnectionPool::Stats ConnectionPool::stats() const {
+    Stats s;
+    s.acquired = acquired_;
+    s.reused = reused_;
+    s.created = created_;
+    s.evicted = evicted_;
+    s.discarded = discarded_;
+    s.warmed = warmed_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    s.idle = idle_.size();
+    return s;
+}
+
+std::unique_ptr<httplib::Client> ConnectionPool::createClient() const {
+    std::unique_ptr<httplib::Client> client(new httplib::Client(host_));
+    client->set_keep_alive(true);
+    if (resolver_) {
+        std::string address = resolver_->resolve(hostname_);
+        if (!address.empty()) {
+            client->set_hostname_addr_map({ { hostname_, address } });
+        }
+    }
+    return client;
+}
+
+void ConnectionPool::release(std::unique_ptr<httplib::Client> client, bool reusable) {
+    std::unique_ptr<httplib::Client> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        leased_.erase(client.get());
+        if (reusable && idle_.size() < maxIdle_) {
+            IdleClient entry;
+            entry.client = std::move(client);
+            entry.lastUsed = std::chrono::steady_clock::now();
+            idle_.push_back(std::move(entry));
+            return;
+        }
+        dropped = std::move(client);
+    }
+    discarded_++;
+    // The dropped client closes its socket here, outside the lock.
+}
+
+// The oldest clients sit at the front, so eviction stops at the first fresh one. Evicted
+// clients are handed to the caller, to be destroyed once the lock is released.
+void ConnectionPool::evictIdleLocked(std::chrono::steady_clock::time_point now, std::deque<IdleClient>& evicted) {
+    while (!idle_.empty() && now - idle_.front().lastUsed > idleTimeout_) {
+        evicted.push_back(std::move(idle_.front()));
+        idle_.pop_front();
+        evicted_++;
+    }
+}
@@ -0,0 +1,82 @@
+// GzipDecoder.cpp
+
+#include "GzipDecoder.h"
+
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+#include <zlib.h>
+
+struct GzipDecoder::Stream {
+    z_stream z;
+};
+
+GzipDecoder::GzipDecoder() : stream_(new Stream()), failed_(false) {
+    // 15 window bits + 32 lets zlib detect gzip and zlib-wrapped deflate headers.
+    if (inflateInit2(&stream_->z, 15 + 32) != Z_OK) {
+        failed_ = true;
+    }
+}
+
+GzipDecoder::~GzipDecoder() {
+    inflateEnd(&stream_->z);
+}
+
+bool GzipDecoder::available() {
+    return true;
+}
+
+// Function to Inflate One Piece of Compressed Input Into the Sink
+bool GzipDecoder::feed(const char* data, size_t size, const DecodedSink& sink) {
+    if (failed_) {
+        return false;
+    }
+    char out[16 * 1024];
+    z_stream& z = stream_->z;
+    z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    z.avail_in = static_cast<uInt>(size);
+    while (z.avail_in > 0) {
+        z.next_out = reinterpret_cast<Bytef*>(out);
+        z.avail_out = sizeof(out);
+        int ret = inflate(&z, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            failed_ = true;
+            return false;
+        }
+        size_t produced = sizeof(out) - z.avail_out;
+        if (produced > 0 && !sink(out, produced)) {
+            failed_ = true;
+            return false;
+        }
+        if (ret == Z_STREAM_END) {
+            break; // Trailing bytes after the gzip member are ignored
+        }
+        if (ret == Z_BUF_ERROR && produced == 0) {
+            break; // Needs more input
+        }
+    }
+    return true;
+}
+
+#else // !CPPHTTPLIB_ZLIB_SUPPORT
+
+struct GzipDecoder::Stream {
+};
+
+GzipDecoder::GzipDecoder() : failed_(true) {
+}
+
+GzipDecoder::~GzipDecoder() {
+}
+
+bool GzipDecoder::available() {
+    return false;
+}
+
+bool GzipDecoder::feed(const char*, size_t, const DecodedSink&) {
+    return false;
+}
+
+#endif // CPPHTTPLIB_ZLIB_SUPPORT
+
+bool isGzipEncoding(const std::string& contentEncoding) {
+    return contentEncoding.find("gzip") != std::string::npos || contentEncoding.find("deflate") != std::string::npos;
+}
@@ -0,0 +1,95 @@
+// HostResolver.cpp
+
+#include "HostResolver.h"
+
+#include <cstring>
+#include <httplib.h> // Brings in the platform socket headers for getaddrinfo() and inet_ntop()
+
+HostResolver::HostResolver(std::chrono::seconds ttl)
+    : ttl_(ttl), hits_(0), lookups_(0), failures_(0), lastLookupMs_(0.0) {
+}
+
+// Function to Resolve a Host Name, From the Cache While the Entry Is Fresh
+std::string HostResolver::resolve(const std::string& host) {
+    auto now = std::chrono::steady_clock::now();
+    std::string stale;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(host);
+        if (it != entries_.end()) {
+            if (now < it->second.expires) {
+                hits_++;
+                return it->second.address;
+            }
+            stale = it->second.address;
+        }
+    }
+
+    // Concurrent misses for one host may both look it up; the later answer wins.
+    lookups_++;
+    std::string address = lookup(host);
+    lastLookupMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - now).count();
+    if (address.empty()) {
+        failures_++;
+        return stale;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[host];
+    entry.address = address;
+    entry.expires = std::chrono::steady_clock::now() + ttl_;
+    return address;
+}
+
+// Function to Expire a Host's Entry, e.g. after its address refused a connection; the address
+// is kept, so it is still served if the next lookup fails
+void HostResolver::expire(const std::string& host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(host);
+    if (it != entries_.end()) {
+        it->second.expires = std::chrono::steady_clock::time_point();
+    }
+}
+
+// Function to Change the Time to Live; entries already cached keep their expiry
+void HostResolver::configure(std::chrono::seconds ttl) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ttl_ = ttl;
+}
+
+// Function to Read the Resolver Counters
+HostResolver::Stats HostResolver::stats() const {
+    Stats s;
+    s.hits = hits_;
+    s.lookups = lookups_;
+    s.failures = failures_;
+    s.lastLookupMs = lastLookupMs_;
+    return s;
+}
+
+// Takes the first address returned, as httplib itself would connect to it first.
+std::string HostResolver::lookup(const std::string& host) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+        return std::string();
+    }
+
+    char buffer[INET6_ADDRSTRLEN] = "";
+    const void* address = nullptr;
+    if (result->ai_family == AF_INET) {
+        address = &reinterpret_cast<const sockaddr_in*>(result->ai_addr)->sin_addr;
+    }
+    else if (result->ai_family == AF_INET6) {
+        address = &reinterpret_cast<const sockaddr_in6*>(result->ai_addr)->sin6_addr;
+    }
+    std::string text;
+    if (address && inet_ntop(result->ai_family, address, buffer, sizeof(buffer))) {
+        text = buffer;
+    }
+    freeaddrinfo(result);
+    return text;
+}
@@ -0,0 +1,435 @@
+// JsonStreamParser.cpp
+
+#include "JsonStreamParser.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+// Function to Check a Number Token Against the JSON Grammar; sets integral when it has no
+// fraction or exponent
+bool validNumber(const std::string& text, bool& integral) {
+    const char* p = text.c_str();
+    if (*p == '-') {
+        p++;
+    }
+    if (*p == '0') {
+        p++;
+    }
+    else if (*p >= '1' && *p <= '9') {
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    else {
+        return false;
+    }
+    integral = true;
+    if (*p == '.') {
+        integral = false;
+        p++;
+        if (!(*p >= '0' && *p <= '9')) {
+            return false;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    if (*p == 'e' || *p == 'E') {
+        integral = false;
+        p++;
+        if (*p == '+' || *p == '-') {
+            p++;
+        }
+        if (!(*p >= '0' && *p <= '9')) {
+            return false;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    return *p == '\0';
+}
+
+void appendUtf8(std::string& out, unsigned codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+} // namespace
+
+JsonStreamParser::JsonStreamParser(Handler& handler)
+    : handler_(handler), state_(Value), token_(NoToken), readingKey_(false),
+      codeUnit_(0), codeDigits_(0), highSurrogate_(0), position_(0) {
+}
+
+// Function to Parse the Next Piece of the Document; a token cut off at the end of the piece
+// is kept and completed by the next one
+bool JsonStreamParser::feed(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        if (state_ == Failed) {
+            return false;
+        }
+        char c = data[i];
+        switch (token_) {
+        case StringToken:
+            i += readString(data + i, size - i);
+            continue;
+        case EscapeToken:
+            if (!readEscape(c)) {
+                return false;
+            }
+            break;
+        case UnicodeToken:
+            if (!readUnicode(c)) {
+                return false;
+            }
+            break;
+        case NumberToken:
+            if (isNumberChar(c)) {
+                text_ += c;
+                break;
+            }
+            if (!endNumber()) {
+                return false;
+            }
+            continue; // The character that ended the number is read again as structure
+        case LiteralToken:
+            if (!readLiteral(c)) {
+                return false;
+            }
+            break;
+        case NoToken:
+            if (!isWhitespace(c) && !structural(c)) {
+                return false;
+            }
+            break;
+        }
+        i++;
+        position_++;
+    }
+    return state_ != Failed;
+}
+
+bool JsonStreamParser::finish() {
+    if (state_ == Failed) {
+        return false;
+    }
+    if (token_ == NumberToken && !endNumber()) {
+        return false;
+    }
+    if (token_ != NoToken || state_ != Done) {
+        return fail("unexpected end of input");
+    }
+    return true;
+}
+
+// Function to Copy String Bytes up to the Closing Quote or the Next Escape
+size_t JsonStreamParser::readString(const char* data, size_t size) {
+    size_t run = 0;
+    while (run < size) {
+        unsigned char c = static_cast<unsigned char>(data[run]);
+        if (c == '"' || c == '\\' || c < 0x20) {
+            break;
+        }
+        run++;
+    }
+    if (highSurrogate_ && run > 0) {
+        fail("unpaired UTF-16 surrogate");
+        return run;
+    }
+    text_.append(data, run);
+    position_ += run;
+    if (run == size) {
+        return run;
+    }
+    char c = data[run];
+    position_++;
+    if (c == '\\') {
+        token_ = EscapeToken;
+    }
+    else if (c == '"') {
+        if (highSurrogate_) {
+            fail("unpaired UTF-16 surrogate");
+        }
+        else {
+            endString();
+        }
+    }
+    else {
+        fail("control character in string");
+    }
+    return run + 1;
+}
+
+bool JsonStreamParser::readEscape(char c) {
+    if (c == 'u') {
+        token_ = UnicodeToken;
+        codeUnit_ = 0;
+        codeDigits_ = 0;
+        return true;
+    }
+    if (highSurrogate_) {
+        return fail("unpaired UTF-16 surrogate");
+    }
+    switch (c) {
+    case '"': text_ += '"'; break;
+    case '\\': text_ += '\\'; break;
+    case '/': text_ += '/'; break;
+    case 'b': text_ += '\b'; break;
+    case 'f': text_ += '\f'; break;
+    case 'n': text_ += '\n'; break;
+    case 'r': text_ += '\r'; break;
+    case 't': text_ += '\t'; break;
+    default: return fail("invalid escape");
+    }
+    token_ = StringToken;
+    return true;
+}
+
+bool JsonStreamParser::readUnicode(char c) {
+    unsigned digit;
+    if (c >= '0' && c <= '9') {
+        digit = c - '0';
+    }
+    else if (c >= 'a' && c <= 'f') {
+        digit = c - 'a' + 10;
+    }
+    else if (c >= 'A' && c <= 'F') {
+        digit = c - 'A' + 10;
+    }
+    else {
+        return fail("invalid \\u escape");
+    }
+    codeUnit_ = (codeUnit_ << 4) | digit;
+    if (++codeDigits_ < 4) {
+        return true;
+    }
+    token_ = StringToken;
+    if (codeUnit_ >= 0xD800 && codeUnit_ <= 0xDBFF) {
+        if (highSurrogate_) {
+            return fail("unpaired UTF-16 surrogate");
+        }
+        highSurrogate_ = codeUnit_; // Completed by the next \uXXXX
+        return true;
+    }
+    if (codeUnit_ >= 0xDC00 && codeUnit_ <= 0xDFFF) {
+        if (!highSurrogate_) {
+            return fail("unpaired UTF-16 surrogate");
+        }
+        appendUtf8(text_, 0x10000 + ((highSurrogate_ - 0xD800) << 10) + (codeUnit_ - 0xDC00));
+        highSurrogate_ = 0;
+        return true;
+    }
+    if (highSurrogate_) {
+        return fail("unpaired UTF-16 surrogate");
+    }
+    appendUtf8(text_, codeUnit_);
+    return true;
+}
+
+bool JsonStreamParser::readLiteral(char c) {
+    static const char* const literals[] = { "true", "false", "null" };
+    text_ += c;
+    for (const char* literal : literals) {
+        if (std::strncmp(literal, text_.c_str(), text_.size()) == 0) {
+            return text_.size() == std::strlen(literal) ? endLiteral() : true;
+        }
+    }
+    return fail("invalid literal");
+}
+
+// Function to Handle a Character Between Tokens
+bool JsonStreamParser::structural(char c) {
+    switch (state_) {
+    case Value:
+        return startValue(c);
+    case ValueOrEnd:
+        if (c == ']') {
+            stack_.pop_back();
+            return valueDone(handler_.end_array());
+        }
+        return startValue(c);
+    case KeyOrEnd:
+        if (c == '}') {
+            stack_.pop_back();
+            return valueDone(handler_.end_object());
+        }
+        state_ = Key;
+        return structural(c);
+    case Key:
+        if (c != '"') {
+            return fail("expected object key");
+        }
+        token_ = StringToken;
+        readingKey_ = true;
+        text_.clear();
+        return true;
+    case Colon:
+        if (c != ':') {
+            return fail("expected ':'");
+        }
+        state_ = Value;
+        return true;
+    case ObjectNext:
+        if (c == ',') {
+            state_ = Key;
+            return true;
+        }
+        if (c == '}') {
+            stack_.pop_back();
+            return valueDone(handler_.end_object());
+        }
+        return fail("expected ',' or '}'");
+    case ArrayNext:
+        if (c == ',') {
+            state_ = Value;
+            return true;
+        }
+        if (c == ']') {
+            stack_.pop_back();
+            return valueDone(handler_.end_array());
+        }
+        return fail("expected ',' or ']'");
+    case Done:
+        return fail("unexpected data after the document");
+    case Failed:
+        break;
+    }
+    return false;
+}
+
+bool JsonStreamParser::startValue(char c) {
+    text_.clear();
+    if (c == '{') {
+        stack_.push_back('{');
+        state_ = KeyOrEnd;
+        return handler_.start_object(static_cast<std::size_t>(-1)) || stop();
+    }
+    if (c == '[') {
+        stack_.push_back('[');
+        state_ = ValueOrEnd;
+        return handler_.start_array(static_cast<std::size_t>(-1)) || stop();
+    }
+    if (c == '"') {
+        token_ = StringToken;
+        readingKey_ = false;
+        return true;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        token_ = NumberToken;
+        text_ += c;
+        return true;
+    }
+    if (c == 't' || c == 'f' || c == 'n') {
+        token_ = LiteralToken;
+        text_ += c;
+        return true;
+    }
+    return fail("unexpected character");
+}
+
+bool JsonStreamParser::endString() {
+    token_ = NoToken;
+    if (readingKey_) {
+        readingKey_ = false;
+        state_ = Colon;
+        return handler_.key(text_) || stop();
+    }
+    return valueDone(handler_.string(text_));
+}
+
+// Numbers follow nlohmann::json: negative integers are signed, others unsigned, and integers
+// that overflow become floating point.
+bool JsonStreamParser::endNumber() {
+    token_ = NoToken;
+    bool integral = false;
+    if (!validNumber(text_, integral)) {
+        return fail("invalid number");
+    }
+    if (integral) {
+        errno = 0;
+        if (text_[0] == '-') {
+            long long value = std::strtoll(text_.c_str(), nullptr, 10);
+            if (errno == 0) {
+                return valueDone(handler_.number_integer(value));
+            }
+        }
+        else {
+            unsigned long long value = std::strtoull(text_.c_str(), nullptr, 10);
+            if (errno == 0) {
+                return valueDone(handler_.number_unsigned(value));
+            }
+        }
+    }
+    double value = std::strtod(text_.c_str(), nullptr);
+    if (std::isinf(value)) {
+        return fail("number overflow"); // nlohmann::json rejects these too
+    }
+    return valueDone(handler_.number_float(value, text_));
+}
+
+bool JsonStreamParser::endLiteral() {
+    token_ = NoToken;
+    if (text_ == "null") {
+        return valueDone(handler_.null());
+    }
+    return valueDone(handler_.boolean(text_ == "true"));
+}
+
+// Function to Move Past a Completed Value, to the Separator Its Container Expects Next
+bool JsonStreamParser::valueDone(bool accepted) {
+    if (!accepted) {
+        return stop();
+    }
+    if (stack_.empty()) {
+        state_ = Done;
+    }
+    else {
+        state_ = stack_.back() == '{' ? ObjectNext : ArrayNext;
+    }
+    return true;
+}
+
+bool JsonStreamParser::fail(const std::string& message) {
+    if (state_ == Failed) {
+        return false;
+    }
+    state_ = Failed;
+    handler_.parse_error(position_, text_, nlohmann::detail::parse_error::create(101, position_, message, nullptr));
+    return false;
+}
+
+// Function to Stop Quietly After the Handler Refused an Event
+bool JsonStreamParser::stop() {
+    state_ = Failed;
+    return false;
+}
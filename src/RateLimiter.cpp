@@ -0,0 +1,231 @@
+// RateLimiter.cpp
+
+#include "RateLimiter.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+struct RateLimiter::Ticket {
+    std::function<void()> job; // Empty for a blocking acquire()
+    CancellationToken cancellation;
+    VisibilityHint visible;
+    bool onScreen; // Last reading of visible, which is only called without the limiter's lock
+    uint64_t sequence;
+    std::chrono::steady_clock::time_point requested;
+    bool granted;
+};
+
+RateLimiter::RateLimiter(double callsPerMinute, double burst)
+    : ratePerSecond_(callsPerMinute / 60.0), burst_(std::max(burst, 1.0)), tokens_(burst_),
+      lastRefill_(std::chrono::steady_clock::now()), nextSequence_(0),
+      granted_(0), delayed_(0), skipped_(0), totalWaitMs_(0.0), maxWaitMs_(0.0), stopping_(false) {
+    dispatcher_ = std::thread(&RateLimiter::dispatchLoop, this);
+}
+
+RateLimiter::~RateLimiter() {
+    shutdown();
+}
+
+void RateLimiter::schedule(RequestPriority priority, std::function<void()> job, CancellationToken cancellation,
+    VisibilityHint visible) {
+    std::shared_ptr<Ticket> ticket(new Ticket());
+    ticket->job = std::move(job);
+    ticket->cancellation = cancellation;
+    ticket->visible = std::move(visible);
+    ticket->onScreen = priority == RequestPriority::Background && onScreen(ticket);
+    ticket->requested = std::chrono::steady_clock::now();
+    ticket->granted = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) {
+            ticket->sequence = nextSequence_++;
+            queueFor(priority, ticket).push_back(ticket);
+            queueChanged_.notify_one();
+            return;
+        }
+    }
+    ticket->job(); // Released at once so it can fail
+}
+
+bool RateLimiter::acquire(RequestPriority priority) {
+    std::shared_ptr<Ticket> ticket(new Ticket());
+    ticket->onScreen = false;
+    ticket->requested = std::chrono::steady_clock::now();
+    ticket->granted = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return false;
+    }
+    ticket->sequence = nextSequence_++;
+    queueFor(priority, ticket).push_back(ticket);
+    queueChanged_.notify_one();
+    ticketGranted_.wait(lock, [this, &ticket] { return ticket->granted || stopping_; });
+    return ticket->granted;
+}
+
+// Function to Change the Rate and Burst Size at Runtime
+void RateLimiter::configure(double callsPerMinute, double burst) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refillLocked(std::chrono::steady_clock::now());
+        ratePerSecond_ = callsPerMinute / 60.0;
+        burst_ = std::max(burst, 1.0);
+        tokens_ = std::min(tokens_, burst_);
+    }
+    queueChanged_.notify_one();
+}
+
+// Function to Move Queued Background Requests Between the Visible and Other Queue After the
+// View Changed; both queues stay in request order. The hints take the viewport's lock, so
+// they are read on a copy of the queues without holding the limiter's: the dispatcher keeps
+// granting meanwhile, and the lock is only retaken to move the tickets.
+void RateLimiter::reprioritize() {
+    std::vector<std::shared_ptr<Ticket>> tickets;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tickets.reserve(visible_.size() + background_.size());
+        tickets.insert(tickets.end(), visible_.begin(), visible_.end());
+        tickets.insert(tickets.end(), background_.begin(), background_.end());
+    }
+    std::vector<char> onScreenNow(tickets.size());
+    for (size_t i = 0; i < tickets.size(); i++) {
+        onScreenNow[i] = onScreen(tickets[i]);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < tickets.size(); i++) {
+        tickets[i]->onScreen = onScreenNow[i] != 0; // Tickets granted since the copy are simply gone from the queues
+    }
+    std::deque<std::shared_ptr<Ticket>> merged;
+    std::merge(visible_.begin(), visible_.end(), background_.begin(), background_.end(), std::back_inserter(merged),
+        [](const std::shared_ptr<Ticket>& a, const std::shared_ptr<Ticket>& b) { return a->sequence < b->sequence; });
+    visible_.clear();
+    background_.clear();
+    for (auto& ticket : merged) {
+        queueFor(RequestPriority::Background, ticket).push_back(ticket);
+    }
+}
+
+// Function to Stop the Dispatcher; queued jobs are released without a token, on the calling
+// thread, so they can fail instead of never running
+void RateLimiter::shutdown() {
+    std::vector<std::shared_ptr<Ticket>> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        for (auto* queue : { &interactive_, &visible_, &background_ }) {
+            for (auto& ticket : *queue) {
+                if (ticket->job) {
+                    released.push_back(ticket); // Blocked acquire() calls are woken instead
+                }
+            }
+            queue->clear();
+        }
+        skipped_ += released.size();
+    }
+    queueChanged_.notify_all();
+    ticketGranted_.notify_all();
+    if (dispatcher_.joinable()) {
+        dispatcher_.join();
+    }
+    for (auto& ticket : released) {
+        ticket->job();
+    }
+}
+
+RateLimiter::Stats RateLimiter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.queuedInteractive = interactive_.size();
+    stats.queuedVisible = visible_.size();
+    stats.queuedBackground = background_.size();
+    stats.granted = granted_;
+    stats.delayed = delayed_;
+    stats.skipped = skipped_;
+    stats.averageWaitMs = granted_ ? totalWaitMs_ / granted_ : 0.0;
+    stats.maxWaitMs = maxWaitMs_;
+    return stats;
+}
+
+void RateLimiter::refillLocked(std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - lastRefill_).count();
+    tokens_ = std::min(burst_, tokens_ + elapsed * ratePerSecond_);
+    lastRefill_ = now;
+}
+
+void RateLimiter::grantLocked(const std::shared_ptr<Ticket>& ticket, std::chrono::steady_clock::time_point now) {
+    double waitMs = std::chrono::duration<double, std::milli>(now - ticket->requested).count();
+    granted_++;
+    if (waitMs >= 1.0) {
+        delayed_++;
+    }
+    totalWaitMs_ += waitMs;
+    maxWaitMs_ = std::max(maxWaitMs_, waitMs);
+    ticket->granted = true;
+}
+
+// Grants the oldest interactive ticket first, then the oldest visible background ticket, then
+// the oldest other background ticket, spending one token each; when the bucket is empty it
+// sleeps until the next token is due. Cancelled jobs are released straight away.
+void RateLimiter::dispatchLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        queueChanged_.wait(lock, [this] { return stopping_ || !interactive_.empty() || !visible_.empty() || !background_.empty(); });
+        if (stopping_) {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        auto& front = !interactive_.empty() ? interactive_ : !visible_.empty() ? visible_ : background_;
+        if (front.front()->job && front.front()->cancellation.cancelled()) {
+            std::function<void()> job = std::move(front.front()->job);
+            front.pop_front();
+            skipped_++;
+            lock.unlock();
+            job();
+            lock.lock();
+            continue;
+        }
+
+        bool unlimited = ratePerSecond_ <= 0.0;
+        if (!unlimited) {
+            refillLocked(now);
+            if (tokens_ < 1.0) {
+                auto wait = std::chrono::duration<double>((1.0 - tokens_) / ratePerSecond_);
+                queueChanged_.wait_for(lock, std::chrono::duration_cast<std::chrono::microseconds>(wait) + std::chrono::microseconds(1));
+                continue;
+            }
+            tokens_ -= 1.0;
+        }
+
+        std::shared_ptr<Ticket> ticket = front.front();
+        front.pop_front();
+        grantLocked(ticket, now);
+
+        if (ticket->job) {
+            std::function<void()> job = std::move(ticket->job);
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+        else {
+            ticketGranted_.notify_all();
+        }
+    }
+}
+
+std::deque<std::shared_ptr<RateLimiter::Ticket>>& RateLimiter::queueFor(RequestPriority priority, const std::shared_ptr<Ticket>& ticket) {
+    if (priority == RequestPriority::Interactive) {
+        return interactive_;
+    }
+    return ticket->onScreen ? visible_ : background_;
+}
+
+bool RateLimiter::onScreen(const std::shared_ptr<Ticket>& ticket) {
+    return ticket->visible && ticket->visible();
+}
@@ -0,0 +1,173 @@
+// RcuDomain.cpp
+
+#include "RcuDomain.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+const size_t kCollectThreshold = 64; // Retired objects gathered before retire() tries to reclaim
+
+std::atomic<uint64_t> nextDomainId(1);
+
+// Reader slots this thread holds, handed back to their domains when it exits. Domains are
+// told apart by id rather than address, since a new one may be built where an old one was.
+struct ThreadSlots {
+    struct Slot {
+        uint64_t domain;
+        void* reader;
+        void (*release)(void*);
+    };
+
+    ~ThreadSlots() {
+        for (const Slot& slot : slots) {
+            slot.release(slot.reader);
+        }
+    }
+
+    std::vector<Slot> slots;
+};
+
+thread_local ThreadSlots threadSlots;
+
+} // namespace
+
+// A reader slot is shared by its domain and the thread that owns it, and deleted by whichever
+// lets go last: a thread may exit after the domain is destroyed, or the other way round.
+struct RcuDomain::Reader {
+    std::atomic<uint64_t> epoch; // Announced by the outermost guard, 0 outside of one
+    std::atomic<bool> owned;
+    std::atomic<unsigned> refs;
+    unsigned depth;              // Only touched by the owning thread
+    Reader* next;
+
+    static void unref(Reader* reader) {
+        if (reader->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete reader;
+        }
+    }
+
+    // Called when the owning thread exits.
+    static void release(void* slot) {
+        Reader* reader = static_cast<Reader*>(slot);
+        reader->owned.store(false, std::memory_order_release);
+        unref(reader);
+    }
+};
+
+RcuDomain::ReadGuard::ReadGuard(RcuDomain& domain) : reader_(domain.reader()) {
+    if (reader_->depth++ == 0) {
+        reader_->epoch.store(domain.epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+}
+
+RcuDomain::ReadGuard::~ReadGuard() {
+    if (--reader_->depth == 0) {
+        reader_->epoch.store(0, std::memory_order_release);
+    }
+}
+
+RcuDomain::RcuDomain()
+    : id_(nextDomainId.fetch_add(1, std::memory_order_relaxed)), epoch_(1), readers_(nullptr), retiredCount_(0), reclaimedCount_(0) {
+}
+
+RcuDomain::~RcuDomain() {
+    for (const Retired& retired : retired_) {
+        retired.deleter(retired.object);
+    }
+    Reader* reader = readers_.load(std::memory_order_acquire);
+    while (reader) {
+        Reader* next = reader->next;
+        Reader::unref(reader);
+        reader = next;
+    }
+}
+
+// Function to Hand an Object No Longer Reachable from Its Pointer to the Domain, to Be Deleted
+// Once No Reader Can Hold It
+void RcuDomain::retire(void* object, void (*deleter)(void*)) {
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex_);
+        Retired retired = { object, deleter, epoch_.load(std::memory_order_seq_cst) };
+        retired_.push_back(retired);
+        retiredCount_++;
+        full = retired_.size() >= kCollectThreshold;
+    }
+    if (full) {
+        collect();
+    }
+}
+
+void RcuDomain::collect() {
+    tryAdvance();
+    uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+    reclaim(epoch - 1); // Retired two or more epochs ago
+}
+
+RcuDomain::Stats RcuDomain::stats() const {
+    std::lock_guard<std::mutex> lock(retiredMutex_);
+    Stats stats = { epoch_.load(std::memory_order_relaxed), retiredCount_, reclaimedCount_, retired_.size() };
+    return stats;
+}
+
+// Function to Find or Claim This Thread's Reader Slot; a new slot is pushed onto the list
+// without a lock
+RcuDomain::Reader* RcuDomain::reader() {
+    for (const ThreadSlots::Slot& slot : threadSlots.slots) {
+        if (slot.domain == id_) {
+            return static_cast<Reader*>(slot.reader);
+        }
+    }
+    Reader* claimed = nullptr;
+    for (Reader* reader = readers_.load(std::memory_order_acquire); reader; reader = reader->next) {
+        bool owned = false;
+        if (!reader->owned.load(std::memory_order_relaxed) && reader->owned.compare_exchange_strong(owned, true, std::memory_order_acq_rel)) {
+            reader->refs.fetch_add(1, std::memory_order_relaxed);
+            claimed = reader;
+            break;
+        }
+    }
+    if (!claimed) {
+        claimed = new Reader();
+        claimed->epoch.store(0, std::memory_order_relaxed);
+        claimed->owned.store(true, std::memory_order_relaxed);
+        claimed->refs.store(2, std::memory_order_relaxed); // The domain's and this thread's
+        claimed->depth = 0;
+        claimed->next = readers_.load(std::memory_order_relaxed);
+        while (!readers_.compare_exchange_weak(claimed->next, claimed, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+    ThreadSlots::Slot slot = { id_, claimed, &Reader::release };
+    threadSlots.slots.push_back(slot);
+    return claimed;
+}
+
+// Function to Move to the Next Epoch, Possible Only Once Every Reader Inside a Guard Has
+// Announced the Current One
+bool RcuDomain::tryAdvance() {
+    uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+    for (Reader* reader = readers_.load(std::memory_order_acquire); reader; reader = reader->next) {
+        uint64_t seen = reader->epoch.load(std::memory_order_seq_cst);
+        if (seen != 0 && seen != epoch) {
+            return false;
+        }
+    }
+    return epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+}
+
+// Function to Delete the Objects Retired Before an Epoch; deleters run outside the lock
+void RcuDomain::reclaim(uint64_t safeBefore) {
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex_);
+        auto pending = std::partition(retired_.begin(), retired_.end(), [safeBefore](const Retired& retired) { return retired.epoch >= safeBefore; });
+        ready.assign(pending, retired_.end());
+        retired_.erase(pending, retired_.end());
+        reclaimedCount_ += ready.size();
+    }
+    for (const Retired& retired : ready) {
+        retired.deleter(retired.object);
+    }
+}
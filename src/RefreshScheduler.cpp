@@ -0,0 +1,192 @@
+// RefreshScheduler.cpp
+
+#include "RefreshScheduler.h"
+
+#include <algorithm>
+
+RefreshScheduler::RefreshScheduler(double jitter)
+    : jitter_(std::min(std::max(jitter, 0.0), 1.0)), nextVersion_(0), random_(std::random_device{}()),
+      paused_(false), refreshes_(0), manualRefreshes_(0) {
+}
+
+// Function to Start Tracking a Key; its slot lands at a random point within one interval so
+// keys tracked together do not all come due together. The slot starts a jitter's width out,
+// so even the earliest jittered refresh is not due straight away.
+void RefreshScheduler::track(CityHandle key, std::chrono::seconds interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        it->second.interval = interval;
+        return;
+    }
+    Entry& entry = entries_[key];
+    entry.interval = interval;
+    entry.manualQueued = false;
+    std::uniform_real_distribution<double> offset(jitter_, 1.0 + jitter_);
+    entry.slot = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval * offset(random_));
+    scheduleLocked(key, entry, entry.slot + jitterLocked(interval));
+}
+
+void RefreshScheduler::untrack(CityHandle key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(key); // Any manual request is skipped when reached
+    dropStaleTopLocked();
+}
+
+bool RefreshScheduler::tracking(CityHandle key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.count(key) != 0;
+}
+
+// Function to Queue a Key for an Immediate Refresh; its scheduled refresh then restarts one
+// interval after the manual one
+void RefreshScheduler::refreshNow(CityHandle key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.manualQueued) {
+        return;
+    }
+    it->second.manualQueued = true;
+    manual_.push_back(key);
+}
+
+// Function to Move a Key's Next Refresh to a Known Time, e.g. just after its data is expected
+// to change; it lands up to one jitter width later so keys pinned together still spread out.
+// Later refreshes repeat every interval from there until the key is pinned again.
+void RefreshScheduler::rescheduleAt(CityHandle key, std::chrono::steady_clock::time_point earliest) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return;
+    }
+    std::uniform_real_distribution<double> offset(0.0, jitter_);
+    it->second.slot = earliest;
+    scheduleLocked(key, it->second, earliest + std::chrono::duration_cast<std::chrono::steady_clock::duration>(it->second.interval * offset(random_)));
+    dropStaleTopLocked();
+}
+
+void RefreshScheduler::pause() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!paused_) {
+        paused_ = true;
+        pausedAt_ = std::chrono::steady_clock::now();
+    }
+}
+
+// Shifting every due time by the pause keeps the spread intact; otherwise every key that fell
+// due while paused would fire at once on resume.
+void RefreshScheduler::resume() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!paused_) {
+        return;
+    }
+    paused_ = false;
+    auto pausedFor = std::chrono::steady_clock::now() - pausedAt_;
+    for (auto& item : entries_) {
+        item.second.slot += pausedFor;
+        item.second.due += pausedFor;
+    }
+    rebuildHeapLocked();
+}
+
+bool RefreshScheduler::paused() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return paused_;
+}
+
+// Function to Pop Up to maxCount Keys That Are Due: manual requests first, then scheduled ones
+// in due order. Each key's slot advances by exactly one interval and the refresh lands within
+// the jitter around it; jitter never accumulates, so the slots keep their even spread. A key
+// that has fallen a whole interval behind restarts one interval from now.
+std::vector<RefreshScheduler::DueRefresh> RefreshScheduler::takeDue(std::chrono::steady_clock::time_point now, size_t maxCount) {
+    std::vector<DueRefresh> due;
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!manual_.empty() && due.size() < maxCount) {
+        CityHandle key = manual_.front();
+        manual_.pop_front();
+        auto it = entries_.find(key);
+        if (it == entries_.end() || !it->second.manualQueued) {
+            continue;
+        }
+        it->second.manualQueued = false;
+        it->second.slot = now + it->second.interval;
+        scheduleLocked(key, it->second, it->second.slot + jitterLocked(it->second.interval));
+        manualRefreshes_++;
+        DueRefresh refresh = { key, true };
+        due.push_back(refresh);
+    }
+
+    while (!paused_ && !heap_.empty() && heap_.top().due <= now && due.size() < maxCount) {
+        HeapNode node = heap_.top();
+        heap_.pop();
+        auto it = entries_.find(node.key);
+        if (it == entries_.end() || it->second.version != node.version) {
+            continue; // Untracked or rescheduled since this node was pushed
+        }
+        Entry& entry = it->second;
+        entry.slot += entry.interval;
+        if (entry.slot <= now) {
+            entry.slot = now + entry.interval;
+        }
+        scheduleLocked(node.key, entry, entry.slot + jitterLocked(entry.interval));
+        refreshes_++;
+        DueRefresh refresh = { node.key, false };
+        due.push_back(refresh);
+    }
+
+    if (heap_.size() > 2 * entries_.size() + 64) {
+        rebuildHeapLocked(); // Too many stale nodes from untracked or rescheduled keys
+    }
+    dropStaleTopLocked();
+    return due;
+}
+
+// Function to Read the Scheduler Counters
+RefreshScheduler::Stats RefreshScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s;
+    s.tracked = entries_.size();
+    s.manualQueued = manual_.size();
+    s.refreshes = refreshes_;
+    s.manualRefreshes = manualRefreshes_;
+    s.paused = paused_;
+    s.nextDueSeconds = -1.0;
+    if (!heap_.empty()) {
+        TimePoint from = paused_ ? pausedAt_ : std::chrono::steady_clock::now();
+        s.nextDueSeconds = std::max(0.0, std::chrono::duration<double>(heap_.top().due - from).count());
+    }
+    return s;
+}
+
+void RefreshScheduler::scheduleLocked(CityHandle key, Entry& entry, TimePoint due) {
+    entry.due = due;
+    entry.version = ++nextVersion_;
+    HeapNode node = { due, entry.version, key };
+    heap_.push(node);
+}
+
+std::chrono::steady_clock::duration RefreshScheduler::jitterLocked(std::chrono::seconds interval) {
+    std::uniform_real_distribution<double> offset(-jitter_, jitter_);
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval * offset(random_));
+}
+
+// Keeps a live node on top of the heap, so stats() can read the next due time directly.
+void RefreshScheduler::dropStaleTopLocked() {
+    while (!heap_.empty()) {
+        auto it = entries_.find(heap_.top().key);
+        if (it != entries_.end() && it->second.version == heap_.top().version) {
+            return;
+        }
+        heap_.pop();
+    }
+}
+
+void RefreshScheduler::rebuildHeapLocked() {
+    std::vector<HeapNode> nodes;
+    nodes.reserve(entries_.size());
+    for (const auto& item : entries_) {
+        HeapNode node = { item.second.due, item.second.version, item.first };
+        nodes.push_back(node);
+    }
+    heap_ = std::priority_queue<HeapNode, std::vector<HeapNode>, LaterDue>(LaterDue(), std::move(nodes));
+}
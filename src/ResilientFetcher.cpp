@@ -0,0 +1,318 @@
+// ResilientFetcher.cpp
+
+#include "ResilientFetcher.h"
+
+#include <algorithm>
+#include <random>
+
+LatencyTracker::LatencyTracker(size_t capacity) : samples_(std::max<size_t>(capacity, 1)), next_(0), count_(0) {
+}
+
+void LatencyTracker::record(double milliseconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_[next_] = milliseconds;
+    next_ = (next_ + 1) % samples_.size();
+    count_ = std::min(count_ + 1, samples_.size());
+}
+
+// Function to Read a Percentile (0.5 = median) of the Recorded Samples
+double LatencyTracker::percentile(double fraction) const {
+    std::vector<double> sorted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sorted.assign(samples_.begin(), samples_.begin() + count_);
+    }
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+size_t LatencyTracker::samples() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+RetryBudget::RetryBudget(double ratio, double cap) : ratio_(ratio), cap_(cap), balance_(cap) {
+}
+
+void RetryBudget::deposit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    balance_ = std::min(cap_, balance_ + ratio_);
+}
+
+bool RetryBudget::withdraw() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (balance_ < 1.0) {
+        return false;
+    }
+    balance_ -= 1.0;
+    return true;
+}
+
+struct ResilientFetcher::Request {
+    RequestPriority priority;
+    AttemptSender send;
+    AsyncCallback callback;
+    CancellationToken cancellation;
+    VisibilityHint visible;
+    std::mutex mutex;
+    bool started;   // Deadline armed by the first attempt that was actually sent
+    bool done;      // Callback delivered (or about to be); later responses are ignored
+    bool hedged;
+    int attempts;
+    int outstanding;
+    std::chrono::steady_clock::time_point deadline;
+    TimerQueue::Id deadlineTimer; // Once started
+    std::unique_ptr<httplib::Response> lastError;
+};
+
+ResilientFetcher::ResilientFetcher(const RetryOptions& options, RateLimiter* limiter)
+    : options_(options), stopped_(false), limiter_(limiter), budget_(options.retryBudgetRatio, options.retryBudgetCap),
+      hedging_(options.hedging), requests_(0), retries_(0), hedges_(0), hedgeWins_(0),
+      deadlineMisses_(0), budgetDenied_(0), cancelled_(0) {
+}
+
+ResilientFetcher::~ResilientFetcher() {
+    shutdown();
+}
+
+// Function to Start a Logical Request; the callback runs once, on whichever thread
+// delivers the deciding response or notices the deadline
+void ResilientFetcher::fetch(RequestPriority priority, AttemptSender send, AsyncCallback callback,
+    CancellationToken cancellation, VisibilityHint visible) {
+    std::shared_ptr<Request> request(new Request());
+    request->priority = priority;
+    request->send = std::move(send);
+    request->callback = std::move(callback);
+    request->cancellation = cancellation;
+    request->visible = std::move(visible);
+    request->started = false;
+    request->done = false;
+    request->hedged = false;
+    request->attempts = 0;
+    request->outstanding = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(activeMutex_);
+        if (!stopped_) {
+            active_[request.get()] = request;
+        }
+        else {
+            request->done = true;
+        }
+    }
+    if (request->done) {
+        request->callback(nullptr);
+        return;
+    }
+    requests_++;
+    budget_.deposit();
+    startAttempt(request, false);
+}
+
+// Function to Stop the Timers and Fail Every Request Still Waiting for an Answer, whether on
+// a retry's backoff, in the rate limiter or on the wire; late responses are then ignored
+void ResilientFetcher::shutdown() {
+    std::vector<std::shared_ptr<Request>> unanswered;
+    {
+        std::lock_guard<std::mutex> lock(activeMutex_);
+        if (stopped_) {
+            return;
+        }
+        stopped_ = true;
+        for (auto& entry : active_) {
+            if (std::shared_ptr<Request> request = entry.second.lock()) {
+                unanswered.push_back(request);
+            }
+        }
+    }
+    timers_.shutdown();
+    for (auto& request : unanswered) {
+        {
+            std::lock_guard<std::mutex> lock(request->mutex);
+            if (request->done) {
+                continue;
+            }
+            request->done = true;
+        }
+        cancelled_++;
+        finish(request, nullptr);
+    }
+}
+
+ResilientFetcher::Stats ResilientFetcher::stats() const {
+    Stats stats;
+    stats.requests = requests_;
+    stats.retries = retries_;
+    stats.hedges = hedges_;
+    stats.hedgeWins = hedgeWins_;
+    stats.deadlineMisses = deadlineMisses_;
+    stats.budgetDenied = budgetDenied_;
+    stats.cancelled = cancelled_;
+    stats.p50Ms = latency_.percentile(0.50);
+    stats.p95Ms = latency_.percentile(0.95);
+    stats.p99Ms = latency_.percentile(0.99);
+    return stats;
+}
+
+void ResilientFetcher::startAttempt(const std::shared_ptr<Request>& request, bool hedge) {
+    if (limiter_) {
+        limiter_->schedule(request->priority, [this, request, hedge] { sendAttempt(request, hedge); },
+            request->cancellation, request->visible);
+    }
+    else {
+        sendAttempt(request, hedge);
+    }
+}
+
+// The deadline starts with the first attempt that leaves the rate limiter, so time spent
+// queued behind the API quota does not count against it.
+void ResilientFetcher::sendAttempt(const std::shared_ptr<Request>& request, bool hedge) {
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::milliseconds timeout;
+    {
+        std::unique_lock<std::mutex> lock(request->mutex);
+        if (request->done) {
+            return;
+        }
+        if (request->cancellation.cancelled()) {
+            if (hedge || request->outstanding > 0) {
+                return; // The attempt already on the wire settles the request
+            }
+            request->done = true;
+            lock.unlock();
+            cancelled_++;
+            finish(request, nullptr);
+            return;
+        }
+        if (!request->started) {
+            request->started = true;
+            request->deadline = now + options_.deadline;
+            request->deadlineTimer = timers_.schedule(options_.deadline, [this, request] {
+                std::unique_ptr<httplib::Response> lastError;
+                {
+                    std::lock_guard<std::mutex> lock(request->mutex);
+                    if (request->done) {
+                        return;
+                    }
+                    request->done = true;
+                    lastError = std::move(request->lastError);
+                }
+                deadlineMisses_++;
+                finish(request, lastError.get());
+            });
+        }
+        if (!hedge) {
+            request->attempts++;
+        }
+        request->outstanding++;
+        timeout = std::max(std::chrono::duration_cast<std::chrono::milliseconds>(request->deadline - now), std::chrono::milliseconds(1));
+
+        if (!hedge && !request->hedged && hedging_ && latency_.samples() >= options_.hedgeMinSamples) {
+            auto hedgeDelay = std::chrono::milliseconds(static_cast<long long>(latency_.percentile(options_.hedgePercentile)) + 1);
+            if (hedgeDelay < timeout) {
+                timers_.schedule(hedgeDelay, [this, request] {
+                    {
+                        std::lock_guard<std::mutex> lock(request->mutex);
+                        if (request->done || request->hedged || request->outstanding == 0 || request->cancellation.cancelled()) {
+                            return;
+                        }
+                        if (!budget_.withdraw()) {
+                            budgetDenied_++;
+                            return;
+                        }
+                        request->hedged = true;
+                    }
+                    hedges_++;
+                    startAttempt(request, true);
+                });
+            }
+        }
+    }
+
+    request->send(timeout, [this, request, now, hedge](const httplib::Response* res) {
+        attemptDone(request, now, hedge, res);
+    });
+}
+
+// Transport errors, 429 and 5xx are retried; anything else is the answer.
+void ResilientFetcher::attemptDone(const std::shared_ptr<Request>& request, std::chrono::steady_clock::time_point sent,
+    bool hedge, const httplib::Response* res) {
+    auto now = std::chrono::steady_clock::now();
+    bool retryable = !res || res->status == 429 || res->status >= 500;
+
+    std::unique_lock<std::mutex> lock(request->mutex);
+    request->outstanding--;
+    if (request->done) {
+        return;
+    }
+    if (!retryable) {
+        request->done = true;
+        lock.unlock();
+        latency_.record(std::chrono::duration<double, std::milli>(now - sent).count());
+        if (hedge) {
+            hedgeWins_++;
+        }
+        finish(request, res);
+        return;
+    }
+
+    if (res) {
+        request->lastError.reset(new httplib::Response(*res));
+    }
+    if (request->outstanding > 0) {
+        return; // The other attempt (original or hedge) may still succeed
+    }
+
+    std::chrono::milliseconds delay = backoff(request->attempts);
+    bool retry = request->attempts < options_.maxAttempts && now + delay < request->deadline && !request->cancellation.cancelled();
+    if (retry && !budget_.withdraw()) {
+        budgetDenied_++;
+        retry = false;
+    }
+    if (!retry) {
+        request->done = true;
+        std::unique_ptr<httplib::Response> lastError = std::move(request->lastError);
+        lock.unlock();
+        finish(request, lastError.get());
+        return;
+    }
+    lock.unlock();
+
+    retries_++;
+    timers_.schedule(delay, [this, request] { startAttempt(request, false); });
+}
+
+// Function to Deliver a Request's Result; the deadline timer is cancelled first, so it does not
+// keep the request and everything its callback holds alive until the deadline passes
+void ResilientFetcher::finish(const std::shared_ptr<Request>& request, const httplib::Response* res) {
+    bool started;
+    TimerQueue::Id deadlineTimer;
+    {
+        std::lock_guard<std::mutex> lock(request->mutex);
+        started = request->started;
+        deadlineTimer = request->deadlineTimer;
+    }
+    if (started) {
+        timers_.cancel(deadlineTimer);
+    }
+    {
+        std::lock_guard<std::mutex> lock(activeMutex_);
+        active_.erase(request.get());
+    }
+    AsyncCallback callback = std::move(request->callback);
+    callback(res);
+}
+
+// Exponential backoff with equal jitter: half of the step is fixed, the other half random,
+// so retries from one burst of failures spread out instead of arriving together.
+std::chrono::milliseconds ResilientFetcher::backoff(int attempt) const {
+    static thread_local std::mt19937 generator(std::random_device{}());
+    long long step = options_.backoffBase.count() << std::min(std::max(attempt - 1, 0), 16);
+    step = std::min(step, static_cast<long long>(options_.backoffCap.count()));
+    std::uniform_int_distribution<long long> jitter(0, step / 2);
+    return std::chrono::milliseconds(step - step / 2 + jitter(generator));
+}
@@ -0,0 +1,152 @@
+// TaskScheduler.cpp
+
+#include "TaskScheduler.h"
+
+namespace {
+
+// The scheduler and deque of the worker running on this thread, if any.
+struct CurrentWorker {
+    const TaskScheduler* scheduler;
+    size_t index;
+};
+
+thread_local CurrentWorker currentWorker = { nullptr, 0 };
+
+} // namespace
+
+TaskScheduler::TaskScheduler(size_t threadCount)
+    : nextWorker_(0), queued_(0), running_(0), sleepers_(0), executed_(0), stolen_(0), stopping_(false) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 2;
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(new Worker());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    shutdown();
+}
+
+// Function to Queue a Task: on the calling worker's own deque, or dealt round-robin when
+// submitted from any other thread. A sleeping worker is only woken if there is one.
+void TaskScheduler::submit(std::function<void()> task) {
+    if (stopping_) {
+        task(); // No worker left to run it
+        return;
+    }
+    size_t target = currentWorker.scheduler == this ? currentWorker.index : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    queued_++; // Counted first, so a worker that sees the count keeps looking instead of sleeping
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->tasks.push_back(std::move(task));
+    }
+    if (sleepers_ > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        taskAvailable_.notify_one();
+    }
+}
+
+// Function to Block Until Every Deque Is Empty and No Task Is Running
+void TaskScheduler::waitIdle() {
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    idle_.wait(lock, [this] { return (queued_ == 0 && running_ == 0) || stopping_; });
+}
+
+// Function to Let Running Tasks Finish, Join All Workers, Then Run the Tasks Still Queued on
+// the Calling Thread; tasks are short, and one may be what completes a waiting request
+void TaskScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        if (stopping_.exchange(true)) {
+            return;
+        }
+        taskAvailable_.notify_all();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    std::deque<std::function<void()>> remaining;
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        queued_ -= worker->tasks.size();
+        for (auto& task : worker->tasks) {
+            remaining.push_back(std::move(task));
+        }
+        worker->tasks.clear();
+    }
+    for (auto& task : remaining) {
+        task();
+    }
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    idle_.notify_all();
+}
+
+bool TaskScheduler::onWorker() const {
+    return currentWorker.scheduler == this;
+}
+
+TaskScheduler::Stats TaskScheduler::stats() const {
+    Stats stats = { executed_.load(), stolen_.load(), queued_.load() };
+    return stats;
+}
+
+void TaskScheduler::workerLoop(size_t self) {
+    currentWorker.scheduler = this;
+    currentWorker.index = self;
+    std::function<void()> task;
+    while (!stopping_) {
+        if (take(self, task)) {
+            task();
+            task = nullptr; // Release what it captured before looking for more
+            finished();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_++; // Announced before the count is checked, so a submit either sees it or is seen
+        taskAvailable_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+        sleepers_--;
+    }
+}
+
+// Function to Take the Next Task for a Worker: the newest from its own deque, otherwise the
+// oldest from the first other deque that has one
+bool TaskScheduler::take(size_t self, std::function<void()>& task) {
+    size_t count = workers_.size();
+    for (size_t i = 0; i < count; i++) {
+        Worker& worker = *workers_[(self + i) % count];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+        }
+        else {
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            stolen_++;
+        }
+        running_++; // Before the task leaves the count, so waitIdle() never sees neither
+        queued_--;
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::finished() {
+    executed_++;
+    if (--running_ == 0 && queued_ == 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        idle_.notify_all();
+    }
+}
@@ -0,0 +1,90 @@
+// TimerQueue.cpp
+
+#include "TimerQueue.h"
+
+TimerQueue::TimerQueue() : nextSequence_(0), stopping_(false) {
+    thread_ = std::thread(&TimerQueue::timerLoop, this);
+}
+
+TimerQueue::~TimerQueue() {
+    shutdown();
+}
+
+// Function to Run a Callback Once the Delay Has Passed
+TimerQueue::Id TimerQueue::schedule(std::chrono::milliseconds delay, std::function<void()> callback) {
+    Id id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextSequence_++;
+        if (stopping_) {
+            return id;
+        }
+        Timer timer = { std::chrono::steady_clock::now() + delay, id };
+        timers_.push(timer);
+        callbacks_.emplace(id, std::move(callback));
+    }
+    changed_.notify_one();
+    return id;
+}
+
+// Function to Drop a Timer That Has Not Run Yet, Releasing Its Callback
+bool TimerQueue::cancel(Id id) {
+    std::function<void()> callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = callbacks_.find(id);
+        if (it == callbacks_.end()) {
+            return false;
+        }
+        callback = std::move(it->second);
+        callbacks_.erase(it);
+    }
+    return true; // The callback is destroyed outside the lock, in case it owns something that schedules
+}
+
+// Function to Drop Pending Timers and Join the Timer Thread
+void TimerQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        timers_ = std::priority_queue<Timer, std::vector<Timer>, Later>();
+        callbacks_.clear();
+    }
+    changed_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t TimerQueue::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return callbacks_.size();
+}
+
+void TimerQueue::timerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        changed_.wait(lock, [this] { return stopping_ || !timers_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        auto due = timers_.top().due;
+        if (std::chrono::steady_clock::now() < due) {
+            changed_.wait_until(lock, due); // Woken early when an earlier timer is scheduled
+            continue;
+        }
+        auto it = callbacks_.find(timers_.top().sequence);
+        timers_.pop();
+        if (it == callbacks_.end()) {
+            continue; // Cancelled
+        }
+        std::function<void()> callback = std::move(it->second);
+        callbacks_.erase(it);
+        lock.unlock();
+        callback();
+        lock.lock();
+    }
+}
@@ -0,0 +1,139 @@
+// UpdateCadence.cpp
+
+#include "UpdateCadence.h"
+
+#include <algorithm>
+
+namespace {
+
+const size_t kGapHistory = 8;
+
+} // namespace
+
+UpdateCadence::UpdateCadence(std::chrono::seconds margin, std::chrono::seconds minimumWait, std::chrono::seconds maximumWait)
+    : margin_(margin), minimumWait_(minimumWait), maximumWait_(maximumWait), fetches_(0), unchanged_(0), firstFetchSum_(0) {
+}
+
+// The next observation is expected one cadence after the last, and is published some delay
+// after that. The delay estimate starts at the margin, grows by a margin each time a fetch
+// comes too early and shrinks slowly while fetches find new data, so it settles just above the
+// real publication delay. A station overdue by more than half a cadence is polled every
+// quarter cadence until it updates again.
+std::chrono::seconds UpdateCadence::observe(CityHandle key, long long dt, long long now) {
+    const long long margin = margin_.count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto inserted = stations_.insert(std::make_pair(key, Station()));
+    Station& station = inserted.first->second;
+    if (inserted.second) {
+        station.lastDt = 0;
+        station.firstFetch = now;
+        station.fetches = 0;
+        station.unchanged = 0;
+        station.delay = margin;
+        firstFetchSum_ += now;
+    }
+
+    station.fetches++;
+    fetches_++;
+    if (dt <= 0) {
+        return std::chrono::seconds(0);
+    }
+    long long cadence = cadenceOf(station);
+    long long previousCadence = cadence;
+    if (dt == station.lastDt) {
+        station.unchanged++;
+        unchanged_++;
+        if (cadence > 0) {
+            station.delay = std::min(station.delay + margin, std::max(margin, cadence / 2));
+        }
+    }
+    else if (dt > station.lastDt) {
+        if (station.lastDt > 0) {
+            station.gaps.push_back(dt - station.lastDt);
+            if (station.gaps.size() > kGapHistory) {
+                station.gaps.pop_front();
+            }
+        }
+        station.lastDt = dt;
+        station.delay = std::max(margin, station.delay - margin / 8);
+    }
+
+    cadence = cadenceOf(station);
+    if (cadence != previousCadence) {
+        countCadence(previousCadence, -1);
+        countCadence(cadence, 1);
+    }
+    if (cadence == 0) {
+        return std::chrono::seconds(0);
+    }
+    long long wait = station.lastDt + cadence + station.delay - now;
+    if (wait <= 0) {
+        wait = cadence / 4;
+    }
+    wait = std::min(std::max(wait, static_cast<long long>(minimumWait_.count())), static_cast<long long>(maximumWait_.count()));
+    return std::chrono::seconds(wait);
+}
+
+void UpdateCadence::forget(CityHandle key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = stations_.find(key);
+    if (it == stations_.end()) {
+        return;
+    }
+    const Station& station = it->second;
+    fetches_ -= station.fetches;
+    unchanged_ -= station.unchanged;
+    firstFetchSum_ -= station.firstFetch;
+    countCadence(cadenceOf(station), -1);
+    stations_.erase(it);
+}
+
+std::chrono::seconds UpdateCadence::cadence(CityHandle key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = stations_.find(key);
+    return std::chrono::seconds(it == stations_.end() ? 0 : cadenceOf(it->second));
+}
+
+// Function to Read the Counters; fixed polling is counted from each key's first fetch,
+// one poll then and one per elapsed interval
+UpdateCadence::Stats UpdateCadence::stats(std::chrono::seconds fixedInterval, long long now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s;
+    s.keys = stations_.size();
+    s.fetches = fetches_;
+    s.unchanged = unchanged_;
+    s.fixedPolls = s.keys;
+    long long elapsed = static_cast<long long>(s.keys) * now - firstFetchSum_;
+    if (fixedInterval.count() > 0 && elapsed > 0) {
+        s.fixedPolls += static_cast<uint64_t>(elapsed / fixedInterval.count());
+    }
+    s.medianCadence = 0.0;
+    size_t known = 0;
+    for (const auto& count : cadences_) {
+        known += count.second;
+    }
+    size_t middle = known / 2; // Same element nth_element picked over the sorted cadences
+    for (const auto& count : cadences_) {
+        if (middle < count.second) {
+            s.medianCadence = static_cast<double>(count.first);
+            break;
+        }
+        middle -= count.second;
+    }
+    return s;
+}
+
+void UpdateCadence::countCadence(long long cadence, int delta) {
+    if (cadence <= 0) {
+        return;
+    }
+    size_t& count = cadences_[cadence];
+    count += delta;
+    if (count == 0) {
+        cadences_.erase(cadence);
+    }
+}
+
+long long UpdateCadence::cadenceOf(const Station& station) {
+    return station.gaps.empty() ? 0 : *std::min_element(station.gaps.begin(), station.gaps.end());
+}
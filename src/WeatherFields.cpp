@@ -0,0 +1,245 @@
+// WeatherFields.cpp
+
+#include "WeatherFields.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+// Function to Format a Unix Time as Local HH:MM into a Six-Byte Buffer
+void formatLocalTime(long long unixTime, char (&text)[6]) {
+    std::time_t t = static_cast<std::time_t>(unixTime);
+    std::tm local;
+#ifdef _WIN32
+    bool converted = localtime_s(&local, &t) == 0;
+#else
+    bool converted = localtime_r(&t, &local) != nullptr;
+#endif
+    if (!converted || std::strftime(text, sizeof(text), "%H:%M", &local) == 0) {
+        text[0] = '\0';
+    }
+}
+
+} // namespace
+
+WeatherSnapshot WeatherFields::snapshot() const {
+    WeatherSnapshot snapshot = WeatherSnapshot();
+    snapshot.valid = found;
+    snapshot.temperatureC = static_cast<float>(temp - 273.15);
+    snapshot.windSpeed = static_cast<float>(windSpeed);
+    snapshot.humidity = humidity;
+    snapshot.observedAt = dt;
+    snapshot.sunrise = sunrise;
+    snapshot.sunset = sunset;
+    if (found & Sunrise) {
+        formatLocalTime(sunrise, snapshot.sunriseText);
+    }
+    if (found & Sunset) {
+        formatLocalTime(sunset, snapshot.sunsetText);
+    }
+    size_t length = std::min(description.size(), sizeof(snapshot.description) - 1);
+    while (length < description.size() && length > 0 && (description[length] & 0xC0) == 0x80) {
+        length--; // Cut before a UTF-8 continuation byte, not in the middle of a character
+    }
+    std::memcpy(snapshot.description, description.data(), length);
+    return snapshot;
+}
+
+WeatherFieldExtractor::WeatherFieldExtractor()
+    : depth_(0), listDepth_(0), firstCondition_(false), key_(OtherKey), failed_(false) {
+}
+
+bool WeatherFieldExtractor::null() {
+    return true;
+}
+
+bool WeatherFieldExtractor::boolean(bool) {
+    return true;
+}
+
+bool WeatherFieldExtractor::number_integer(number_integer_t value) {
+    return number(static_cast<double>(value));
+}
+
+bool WeatherFieldExtractor::number_unsigned(number_unsigned_t value) {
+    return number(static_cast<double>(value));
+}
+
+bool WeatherFieldExtractor::number_float(number_float_t value, const string_t&) {
+    return number(value);
+}
+
+bool WeatherFieldExtractor::string(string_t& value) {
+    if (scope() == Condition && key_ == DescriptionKey) {
+        entry().description.swap(value);
+        entry().found |= WeatherFields::Description;
+    }
+    return true;
+}
+
+bool WeatherFieldExtractor::binary(binary_t&) {
+    return true;
+}
+
+bool WeatherFieldExtractor::start_object(std::size_t) {
+    enter(childScope(false));
+    return true;
+}
+
+// Keys are matched against the few names the app reads; the rest leave key_ at OtherKey.
+bool WeatherFieldExtractor::key(string_t& value) {
+    static const struct {
+        const char* name;
+        Key key;
+    } keys[] = {
+        { "id", IdKey }, { "dt", DtKey }, { "main", MainKey }, { "wind", WindKey }, { "sys", SysKey },
+        { "weather", WeatherKey }, { "list", ListKey }, { "temp", TempKey }, { "humidity", HumidityKey },
+        { "speed", SpeedKey }, { "sunrise", SunriseKey }, { "sunset", SunsetKey }, { "description", DescriptionKey }
+    };
+    key_ = OtherKey;
+    if (scope() == Skip) {
+        return true;
+    }
+    for (const auto& known : keys) {
+        if (std::strcmp(value.c_str(), known.name) == 0) {
+            key_ = known.key;
+            break;
+        }
+    }
+    return true;
+}
+
+bool WeatherFieldExtractor::end_object() {
+    leave();
+    return true;
+}
+
+bool WeatherFieldExtractor::start_array(std::size_t) {
+    enter(childScope(true));
+    return true;
+}
+
+bool WeatherFieldExtractor::end_array() {
+    leave();
+    return true;
+}
+
+bool WeatherFieldExtractor::parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) {
+    failed_ = true;
+    return false;
+}
+
+WeatherFieldExtractor::Scope WeatherFieldExtractor::scope() const {
+    return depth_ == 0 || depth_ > kMaxDepth ? Skip : scopes_[depth_ - 1];
+}
+
+// Function to Work Out What a Container Opening in the Current Scope Holds
+WeatherFieldExtractor::Scope WeatherFieldExtractor::childScope(bool array) {
+    if (depth_ == 0) {
+        return array ? Skip : Entry;
+    }
+    switch (scope()) {
+    case Entry:
+        if (array) {
+            if (key_ == WeatherKey) {
+                return Conditions;
+            }
+            return key_ == ListKey && depth_ == 1 ? List : Skip;
+        }
+        return key_ == MainKey ? Main : key_ == WindKey ? Wind : key_ == SysKey ? Sys : Skip;
+    case Conditions:
+        if (!array && firstCondition_) {
+            firstCondition_ = false;
+            return Condition;
+        }
+        return Skip;
+    case List:
+        if (!array) {
+            list_.push_back(WeatherFields());
+            return Entry;
+        }
+        return Skip;
+    default:
+        return Skip;
+    }
+}
+
+void WeatherFieldExtractor::enter(Scope scope) {
+    depth_++;
+    if (depth_ <= kMaxDepth) {
+        scopes_[depth_ - 1] = scope;
+    }
+    if (scope == Conditions) {
+        firstCondition_ = true;
+    }
+    else if (scope == List) {
+        listDepth_ = depth_;
+    }
+    key_ = OtherKey;
+}
+
+void WeatherFieldExtractor::leave() {
+    if (depth_ == listDepth_) {
+        listDepth_ = 0;
+    }
+    if (depth_ > 0) {
+        depth_--;
+    }
+    key_ = OtherKey;
+}
+
+// Function to Find the Record the Current Entry Writes Into
+WeatherFields& WeatherFieldExtractor::entry() {
+    return listDepth_ > 0 && depth_ > listDepth_ ? list_.back() : root_;
+}
+
+bool WeatherFieldExtractor::number(double value) {
+    WeatherFields& fields = entry();
+    switch (scope()) {
+    case Entry:
+        if (key_ == IdKey) {
+            fields.id = static_cast<int>(value);
+            fields.found |= WeatherFields::Id;
+        }
+        else if (key_ == DtKey) {
+            fields.dt = static_cast<long long>(value);
+            fields.found |= WeatherFields::Time;
+        }
+        break;
+    case Main:
+        if (key_ == TempKey) {
+            fields.temp = value;
+            fields.found |= WeatherFields::Temperature;
+        }
+        else if (key_ == HumidityKey) {
+            fields.humidity = static_cast<int>(value);
+            fields.found |= WeatherFields::Humidity;
+        }
+        break;
+    case Wind:
+        if (key_ == SpeedKey) {
+            fields.windSpeed = value;
+            fields.found |= WeatherFields::WindSpeed;
+        }
+        break;
+    case Sys:
+        if (key_ == SunriseKey) {
+            fields.sunrise = static_cast<long long>(value);
+            fields.found |= WeatherFields::Sunrise;
+        }
+        else if (key_ == SunsetKey) {
+            fields.sunset = static_cast<long long>(value);
+            fields.found |= WeatherFields::Sunset;
+        }
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+bool extractWeatherFields(const std::string& body, WeatherFieldExtractor& extractor) {
+    return nlohmann::json::sax_parse(body, &extractor) && !extractor.failed();
+}
@@ -2,31 +2,129 @@
 
 #include "WeatherForecast.h"
 
+// The test build points every request at a local mock server instead
+#ifndef WEATHERFORECAST_API_HOST
+#define WEATHERFORECAST_API_HOST "http://api.openweathermap.org"
+#endif
+
 // Constants: These define constant values used throughout the program.
 const std::string base_url = "http://api.openweathermap.org/data/2.5/weather";
 const std::string favorites_file = "favorites.txt";
 std::string api_key;
+const std::string api_host = WEATHERFORECAST_API_HOST;
+const size_t fetch_worker_count = 0; // 0 sizes the fetch pool from the hardware concurrency
+const size_t task_worker_count = 0; // 0 gives the parse and derive tasks one worker per hardware thread
+const size_t group_batch_size = 20; // Maximum number of city IDs accepted by /data/2.5/group
+const size_t event_loop_threads = 2;
+const size_t event_loop_max_connections = 512; // Keep below the process file-descriptor limit
+const double api_calls_per_minute = 60; // OpenWeatherMap free-tier quota; 0 disables pacing
+const double api_burst = 10;
+const RetryOptions fetch_retry_options = {
+    std::chrono::milliseconds(10000), // Deadline per request, across all attempts
+    3,                                // Attempts
+    std::chrono::milliseconds(250),   // Backoff base
+    std::chrono::milliseconds(2000),  // Backoff cap
+    0.2,                              // Retry budget: one retry or hedge per five requests...
+    10,                               // ...plus a reserve of ten
+    false,                            // Hedging, toggled from the UI
+    0.95,                             // Hedge after the p95 attempt latency
+    20                                // Samples needed before hedging
+};
+const std::chrono::seconds dns_cache_ttl(300); // getaddrinfo() hides the record TTL, so use a fixed one
+const size_t warm_connection_count = 4; // Keep-alive connections opened at startup; 0 skips the warm-up
+const std::chrono::milliseconds warm_up_timeout(3000);
+const std::chrono::seconds auto_refresh_interval(600); // OpenWeatherMap updates roughly every 10 minutes
+const double auto_refresh_jitter = 0.1; // Each refresh interval varies by up to 10%
+const size_t refreshes_per_frame = 64;
+const std::chrono::seconds observation_margin(60); // Wait past an expected observation for it to be published
+const std::chrono::seconds minimum_refresh_wait(60);
+const std::chrono::seconds maximum_refresh_wait(3 * 3600);
+const size_t result_batch_size = 64; // Results applied between checks of the frame's budget
+const std::chrono::microseconds result_apply_budget(2000);
+const BreakerOptions circuit_breaker_options = {
+    20,                               // Window of recent calls
+    5,                                // Calls before the breaker may trip
+    0.5,                              // Trip when half the window failed...
+    std::chrono::milliseconds(4000),  // ...counting calls slower than 4 s as failures
+    std::chrono::milliseconds(30000), // Stay open for 30 s before probing
+    2                                 // Probes that must succeed to close
+};
+
+// Fetch Options
+std::atomic<bool> batchFetchMode(false);
+std::atomic<uint64_t> fetchGeneration(0);
+std::atomic<FetchBackend> fetchBackend(FetchBackend::ThreadPool);
+std::atomic<bool> compressedTransfer(false);
+std::atomic<bool> streamingParse(true);
 
 // Initial List of Cities
-std::vector<City> cities = {
-    {"New York", -74.0060, 40.7128, false, nullptr},
-    {"Los Angeles", -118.2437, 34.0522, false, nullptr},
-    {"Tel Aviv", 34.7818, 32.0853, false, nullptr},
-    {"Madrid", -3.7038, 40.4168, false, nullptr},
-    {"Moscow", 37.6173, 55.7558, false, nullptr},
-    {"London", -0.1276, 51.5074, false, nullptr},
-    {"Paris", 2.3522, 48.8566, false, nullptr},
-    {"Berlin", 13.4050, 52.5200, false, nullptr},
-    {"Tokyo", 139.6917, 35.6895, false, nullptr},
-    {"Sydney", 151.2093, -33.8688, false, nullptr},
-    {"Bangkok", 100.5018, 13.7563, false, nullptr}
+CityStore cities = {
+    {"New York", -74.0060, 40.7128},
+    {"Los Angeles", -118.2437, 34.0522},
+    {"Tel Aviv", 34.7818, 32.0853},
+    {"Madrid", -3.7038, 40.4168},
+    {"Moscow", 37.6173, 55.7558},
+    {"London", -0.1276, 51.5074},
+    {"Paris", 2.3522, 48.8566},
+    {"Berlin", 13.4050, 52.5200},
+    {"Tokyo", 139.6917, 35.6895},
+    {"Sydney", 151.2093, -33.8688},
+    {"Bangkok", 100.5018, 13.7563}
 };
 
+// Cached DNS Answers for the Upstream Host
+HostResolver hostResolver(dns_cache_ttl);
+
+// Shared Keep-Alive Connections to the OpenWeatherMap Host
+ConnectionPool connectionPool(api_host, 16, std::chrono::seconds(30), &hostResolver);
+
+// Client-Side Pacing of All Calls Against the API Key's Quota
+RateLimiter apiRateLimiter(api_calls_per_minute, api_burst);
+
+// Deadlines, Retries and Hedging for Every Upstream Request
+ResilientFetcher resilientFetcher(fetch_retry_options, &apiRateLimiter);
+
+// Function to Log a Circuit Breaker Changing State
+static void logBreakerTransition(const CircuitBreaker& breaker, const CircuitBreaker::Transition& transition) {
+    std::cerr << "Circuit breaker for " << breaker.name() << ": " << CircuitBreaker::stateName(transition.from)
+              << " -> " << CircuitBreaker::stateName(transition.to) << " (" << transition.reason << ")" << std::endl;
+}
+
+// Circuit Breakers for Each Upstream Endpoint: per-city weather, group weather and geocoding
+CircuitBreaker weatherBreaker("weather", circuit_breaker_options, logBreakerTransition);
+CircuitBreaker groupBreaker("group weather", circuit_breaker_options, logBreakerTransition);
+CircuitBreaker geocodeBreaker("geocoding", circuit_breaker_options, logBreakerTransition);
+
+// Background Refresh Schedule for the Cities on Display
+RefreshScheduler refreshScheduler(auto_refresh_jitter);
+
+// Observed Update Cadence of Each City's Weather Station
+UpdateCadence updateCadence(observation_margin, minimum_refresh_wait, maximum_refresh_wait);
+
+// Last Known Answers, Served from Memory While an Endpoint's Breaker Is Not Closed
+static std::mutex lastKnownMutex;
+static std::map<std::string, CityWeather> lastKnownWeather; // By weather flight key
+static std::map<std::string, GeoLookup> lastKnownLocations;  // By geocoding flight key
+
+// In-Flight Requests Shared by Callers Asking for the Same Location or City Name
+SingleFlight<CityWeather> weatherFlights;
+SingleFlight<GeoLookup> geocodeFlights;
+
+// Finished Fetches Waiting for the UI Thread
+MpscQueue<WeatherResult> weatherResults;
+
 // Global Variables for Threading
-std::mutex weatherDataMutex;
-std::atomic<int> threadsFinished(0);
+WorkerPool fetchWorkers(fetch_worker_count);
+TaskScheduler weatherTasks(task_worker_count); // Parses responses and derives snapshots off the I/O threads
+FetchProgress fetchProgress;
+TransferStats transferStats;
+RevalidationStats revalidationStats;
+ViewportHint viewportHint;
+StartupTimings startupTimings;
+ResultApplyStats resultApplyStats;
+static std::thread warmUpThread;
 
-// Function to Read API Key from File
+// Function to Read API Key from File; empty if it cannot be read
 std::string readApiKeyFromFile(const std::string& filePath) {
     std::ifstream keyFile(filePath);
     std::string key;
@@ -36,55 +134,859 @@ std::string readApiKeyFromFile(const std::string& filePath) {
     }
     else {
         std::cerr << "Unable to open API key file: " << filePath << std::endl;
-        exit(EXIT_FAILURE); // Exit if API key cannot be read
     }
     return key;
 }
 
-// Function to Fetch Weather Data for a City
-void fetchWeatherDataForCity(City& city) {
-    httplib::Client cli("http://api.openweathermap.org");
-    std::string url = "/data/2.5/weather?lat=" + std::to_string(city.lat) + "&lon=" + std::to_string(city.lon) + "&appid=" + api_key;
+// Function to Build the Per-City Weather Request Path
+static std::string weatherPathForCity(CityIndex city) {
+    return "/data/2.5/weather?lat=" + std::to_string(cities.lat(city)) + "&lon=" + std::to_string(cities.lon(city)) + "&appid=" + api_key;
+}
+
+// Function to Build the Coalescing Key for a Per-City Request: endpoint plus coordinates
+// rounded to about 10 m, so duplicate entries for one place share a request
+static std::string weatherFlightKey(CityIndex city) {
+    char key[64];
+    std::snprintf(key, sizeof(key), "weather:%.4f,%.4f", cities.lat(city), cities.lon(city));
+    return key;
+}
+
+// Function to Keep a Successful Weather Result as the Last Known Data for Its Location
+static void rememberWeather(const std::string& key, const CityWeather& weather) {
+    std::lock_guard<std::mutex> lock(lastKnownMutex);
+    lastKnownWeather[key] = weather;
+}
 
-    auto res = cli.Get(url.c_str());
-    if (res && res->status == 200) {
-        std::lock_guard<std::mutex> lock(weatherDataMutex);
-        city.weatherData = nlohmann::json::parse(res->body);
+// Function to Serve the Last Known Weather for a Location in Place of a Failed Request;
+// false when nothing is known about it
+static bool recallWeather(const std::string& key, CityHandle city, CityWeather& weather) {
+    std::lock_guard<std::mutex> lock(lastKnownMutex);
+    auto it = lastKnownWeather.find(key);
+    if (it == lastKnownWeather.end()) {
+        return false;
     }
-    else {
-        std::cerr << "Failed to fetch weather data for " << city.name << std::endl;
+    weather = it->second;
+    weather.source = city;
+    weather.notModified = false;
+    weather.lastKnown = true;
+    return true;
+}
+
+// Function to Learn a City's Update Cadence from the `dt` of Weather It Was Just Sent, and Pin
+// Its Next Background Refresh to Just After the Next Observation Is Expected
+static void scheduleAfterNextObservation(CityHandle city, const WeatherSnapshot& weatherData) {
+    long long dt = weatherData.has(WeatherFields::Time) ? weatherData.observedAt : 0;
+    long long now = static_cast<long long>(std::time(nullptr));
+    std::chrono::seconds wait = updateCadence.observe(city, dt, now);
+    if (wait.count() > 0) {
+        refreshScheduler.rescheduleAt(city, std::chrono::steady_clock::now() + wait);
     }
-    threadsFinished++;
 }
 
-// Function to Validate if a City Name is Valid
-bool validateCity(const std::string& cityName, double& lon, double& lat) {
-    httplib::Client cli("http://api.openweathermap.org");
-    std::string url = "/geo/1.0/direct?q=" + cityName + "&limit=1&appid=" + api_key;
+// Function to Create the Parsed Body for a Weather Request, or nullptr to buffer the body and
+// extract its fields once it is complete
+static std::shared_ptr<ParsedBody> streamedBody() {
+    return streamingParse ? std::make_shared<ParsedBody>() : nullptr;
+}
 
-    auto res = cli.Get(url.c_str());
-    if (res && res->status == 200) {
-        auto data = nlohmann::json::parse(res->body);
-        if (!data.empty()) {
-            lon = data[0]["lon"];
-            lat = data[0]["lat"];
+// Function to Take the Weather Fields of a 200 Response: extracted while the body streamed in
+// when there is a parsed body, from the buffered body otherwise. False if it was not valid JSON.
+static bool responseFields(const httplib::Response& res, const std::shared_ptr<ParsedBody>& parsed, WeatherFields& fields,
+    std::vector<WeatherFields>& list) {
+    if (parsed) {
+        std::lock_guard<std::mutex> lock(parsed->mutex);
+        if (!parsed->ready) {
+            return false;
+        }
+        fields = std::move(parsed->fields);
+        list.swap(parsed->list);
+        return true;
+    }
+    WeatherFieldExtractor extractor;
+    if (!extractWeatherFields(res.body, extractor)) {
+        return false;
+    }
+    fields = std::move(extractor.fields());
+    list.swap(extractor.list());
+    return true;
+}
+
+// Parsed Per-City Response Waiting for Its Derive Task: the flight result without its
+// snapshot, and the fields the snapshot is built from when the body was fresh
+struct ParsedWeather {
+    CityWeather weather;
+    bool fresh;
+    WeatherFields fields;
+};
+
+// Function to Parse a Per-City Weather Response for a Flight Result; res is nullptr on
+// transport errors, and a 304 reuses the cached body the request was revalidating
+static void parseWeatherResponse(CityHandle source, const httplib::Response* res, const std::shared_ptr<ParsedBody>& parsed,
+    const std::shared_ptr<const CityWeather>& cached, ParsedWeather& result) {
+    CityWeather weather = { source, false, false, false, WeatherSnapshot(), 0, CacheValidators() };
+    result.weather = weather;
+    result.fresh = false;
+    if (res && res->status == 304) {
+        revalidationStats.recordNotModified();
+        if (cached) {
+            result.weather = *cached; // Not modified: keep the cached weatherData without parsing anything
+        }
+    }
+    else if (res && res->status == 200) {
+        std::vector<WeatherFields> list;
+        if (!responseFields(*res, parsed, result.fields, list)) {
+            return;
+        }
+        result.fresh = true;
+        result.weather.received = true;
+        result.weather.owmId = result.fields.id; // Remember the ID for group requests
+        result.weather.validators.etag = res->get_header_value("ETag");
+        result.weather.validators.lastModified = res->get_header_value("Last-Modified");
+    }
+}
+
+// Function to Run a Response Handler on a Task Worker: an I/O thread hands over a copy of the
+// response and goes back to the wire instead of parsing it, while a task worker runs it at once
+static void onWeatherTask(const httplib::Response* res, const std::function<void(const httplib::Response*)>& handler) {
+    if (weatherTasks.onWorker()) {
+        handler(res);
+        return;
+    }
+    std::shared_ptr<httplib::Response> copy = res ? std::make_shared<httplib::Response>(*res) : nullptr;
+    weatherTasks.submit([copy, handler] { handler(copy.get()); });
+}
+
+// Function to Build the Group Request Path for a Batch of Cities with Known IDs
+static std::string groupPathForBatch(const std::vector<CityHandle>& batch) {
+    std::set<int> seen;
+    std::string ids;
+    for (CityHandle handle : batch) {
+        CityIndex city;
+        if (cities.resolve(handle, city) && seen.insert(cities.owmId(city)).second) {
+            ids += (ids.empty() ? "" : ",") + std::to_string(cities.owmId(city));
+        }
+    }
+    return "/data/2.5/group?id=" + ids + "&appid=" + api_key;
+}
+
+// Function to Queue a Group Response for the UI Thread, Which Fans It Back Out to the Cities
+// of the Batch: the body is parsed in one task and the entries' snapshots derived in another
+static void queueGroupResponse(const std::vector<CityHandle>& batch, const httplib::Response* res, const std::shared_ptr<ParsedBody>& parsed,
+    uint64_t generation, bool counted) {
+    onWeatherTask(res, [batch, parsed, generation, counted](const httplib::Response* res) {
+        std::shared_ptr<std::vector<WeatherFields>> list = std::make_shared<std::vector<WeatherFields>>();
+        WeatherFields group;
+        if (!(res && res->status == 200 && responseFields(*res, parsed, group, *list))) {
+            list->clear();
+        }
+        weatherTasks.submit([batch, list, generation, counted] {
+            WeatherResult result = WeatherResult();
+            result.kind = WeatherResult::GroupResult;
+            result.generation = generation;
+            result.counted = counted;
+            result.batch = batch;
+            for (const auto& fields : *list) {
+                result.entries.push_back(std::make_pair(fields.id, fields.snapshot()));
+            }
+            result.serveLastKnown = groupBreaker.state() != BreakerState::Closed;
+            result.queued = std::chrono::steady_clock::now();
+            resultApplyStats.recordQueued();
+            weatherResults.push(std::move(result));
+        });
+    });
+}
+
+// Function to Fan a Group Response Back Out to the Cities of the Batch; results for a
+// superseded fetch cycle, or for cities removed since the request was sent, are dropped
+static void applyGroupResult(const WeatherResult& result) {
+    if (result.generation != fetchGeneration) {
+        return;
+    }
+    std::map<int, std::vector<CityIndex>> citiesById;
+    for (CityHandle handle : result.batch) {
+        CityIndex city;
+        if (cities.resolve(handle, city)) {
+            citiesById[cities.owmId(city)].push_back(city);
+        }
+    }
+    for (const auto& entry : result.entries) {
+        auto it = citiesById.find(entry.first);
+        if (it == citiesById.end()) {
+            continue;
+        }
+        startupTimings.recordFirstWeather();
+        for (CityIndex city : it->second) {
+            cities.setWeather(city, entry.second); // Fan the group entry back out to each matching city
+            cities.setValidators(city, CacheValidators()); // Per-city validators no longer describe this body
+            CityWeather weather = { cities.handle(city), true, false, false, entry.second, cities.owmId(city), CacheValidators() };
+            rememberWeather(weatherFlightKey(city), weather);
+            scheduleAfterNextObservation(cities.handle(city), entry.second);
+        }
+        citiesById.erase(it);
+    }
+    for (const auto& missing : citiesById) {
+        for (CityIndex city : missing.second) {
+            CityWeather weather;
+            if (result.serveLastKnown && recallWeather(weatherFlightKey(city), cities.handle(city), weather)) {
+                cities.setWeather(city, weather.weatherData);
+                continue;
+            }
+            std::cerr << "Failed to fetch weather data for " << cities.name(city) << std::endl;
+        }
+    }
+}
+
+// Function to Build the Headers Sent with Every Upstream Request
+static httplib::Headers requestHeaders() {
+    httplib::Headers headers;
+    if (compressedTransfer && GzipDecoder::available()) {
+        headers.emplace("Accept-Encoding", "gzip, deflate");
+    }
+    return headers;
+}
+
+// Function to Build the Headers for a Per-City Request, Revalidating the Cached Response
+// when there is one; cached is then set to what a 304 would stand for. Called on the UI
+// thread, which owns the cache.
+static httplib::Headers requestHeadersForCity(CityHandle handle, std::shared_ptr<const CityWeather>& cached) {
+    httplib::Headers headers = requestHeaders();
+    CityIndex city;
+    if (!cities.resolve(handle, city)) {
+        return headers;
+    }
+    const CacheValidators& validators = cities.validators(city);
+    if (!cities.hasWeather(city) || validators.empty()) {
+        return headers;
+    }
+    CityWeather weather = { handle, true, true, false, *cities.weather(city), cities.owmId(city), validators };
+    cached = std::make_shared<CityWeather>(weather);
+    if (!validators.etag.empty()) {
+        headers.emplace("If-None-Match", validators.etag);
+    }
+    if (!validators.lastModified.empty()) {
+        headers.emplace("If-Modified-Since", validators.lastModified);
+    }
+    revalidationStats.recordConditional();
+    return headers;
+}
+
+// Function to GET a Path on a Pooled Keep-Alive Connection; compressed bodies are inflated
+// chunk by chunk as they arrive, so only the decoded body is ever buffered, and not even that
+// when the body receiver takes it
+static bool pooledGet(const std::string& path, const httplib::Headers& headers, std::chrono::milliseconds timeout,
+    const CancellationToken& cancellation, const BodyReceiver& receiver, httplib::Response& response) {
+    auto cli = connectionPool.acquire();
+    if (cancellation.cancelled() || connectionPool.stopped()) {
+        return false; // Checked after the lease is registered, so a later stopAll() reaches it
+    }
+    cli->set_decompress(false); // Inflate here instead of in httplib so the wire size can be counted
+    cli->set_connection_timeout(timeout); // Each socket operation is bounded by the time left to the deadline
+    cli->set_read_timeout(timeout);
+    cli->set_write_timeout(timeout);
+
+    std::unique_ptr<GzipDecoder> decoder;
+    std::string body;
+    size_t wireBytes = 0;
+    size_t decodedBytes = 0;
+    DecodedSink deliver = [&body, &decodedBytes](const char* data, size_t size) {
+        decodedBytes += size;
+        body.append(data, size);
+        return true;
+    };
+    auto res = cli->Get(path, headers,
+        [&decoder, &receiver, &deliver, &decodedBytes](const httplib::Response& head) {
+            if (isGzipEncoding(head.get_header_value("Content-Encoding")) && GzipDecoder::available()) {
+                decoder.reset(new GzipDecoder());
+            }
+            DecodedSink sink = receiver ? receiver(head) : DecodedSink();
+            if (sink) {
+                deliver = [sink, &decodedBytes](const char* data, size_t size) {
+                    decodedBytes += size;
+                    return sink(data, size);
+                };
+            }
             return true;
+        },
+        [&decoder, &deliver, &wireBytes](const char* data, size_t size) {
+            wireBytes += size;
+            return decoder ? decoder->feed(data, size, deliver) : deliver(data, size);
+        });
+    if (!res) {
+        cli.discard(); // Transport error: do not hand this connection out again
+        return false;
+    }
+    response = res.value();
+    response.body.swap(body);
+    transferStats.record(wireBytes, decodedBytes);
+    return true;
+}
+
+// Function to Join the Weather Flight for a City on Behalf of a Fetch Cycle; true means the
+// caller must issue the request. The flight's result is queued for the UI thread.
+static bool joinWeatherFlight(CityHandle handle, const std::string& key, uint64_t generation, bool counted) {
+    return weatherFlights.join(key, [handle, generation, counted](const CityWeather& weather) {
+        WeatherResult result = WeatherResult();
+        result.kind = WeatherResult::CityResult;
+        result.generation = generation;
+        result.counted = counted;
+        result.city = handle;
+        result.weather = weather;
+        result.queued = std::chrono::steady_clock::now();
+        resultApplyStats.recordQueued();
+        weatherResults.push(std::move(result));
+    }, generation);
+}
+
+// Function to Store a Flight's Result on a City That Joined It; it is only stored if the cycle
+// is still current and the city has not been removed, and only counts toward the cycle's
+// progress if the city is one of the cycle's own
+static void applyCityResult(const WeatherResult& result) {
+    const CityWeather& weather = result.weather;
+    CityIndex city;
+    bool current = result.generation == fetchGeneration && cities.resolve(result.city, city);
+    if (current && weather.received && !(weather.notModified && weather.source == result.city)) {
+        cities.setWeather(city, weather.weatherData);
+        startupTimings.recordFirstWeather();
+        cities.setOwmId(city, weather.owmId);
+        cities.setValidators(city, weather.validators);
+    }
+    if (current && !weather.received) {
+        std::cerr << "Failed to fetch weather data for " << cities.name(city) << std::endl;
+    }
+    if (current && weather.received && !weather.lastKnown) {
+        scheduleAfterNextObservation(result.city, weather.weatherData);
+    }
+    if (result.counted) {
+        fetchProgress.complete(result.generation);
+    }
+}
+
+// Function to Apply the Results Workers Have Queued, on the UI Thread at the Top of a Frame: in
+// batches of result_batch_size until the queue is empty or result_apply_budget is spent, so a
+// burst of results is spread over several frames instead of stalling one. Returns how many
+// were applied.
+size_t applyWeatherResults() {
+    auto start = std::chrono::steady_clock::now();
+    auto now = start;
+    size_t applied = 0;
+    WeatherResult result;
+    bool more = true;
+    while (more && now - start < result_apply_budget) {
+        for (size_t i = 0; i < result_batch_size; i++) {
+            if (!weatherResults.pop(result)) {
+                more = false;
+                break;
+            }
+            auto taken = std::chrono::steady_clock::now(); // Results pushed during the drain are newer than now
+            resultApplyStats.recordTaken(std::chrono::duration<double, std::milli>(taken - result.queued).count());
+            if (result.kind == WeatherResult::CityResult) {
+                applyCityResult(result);
+            }
+            else {
+                applyGroupResult(result);
+                if (result.counted) {
+                    fetchProgress.complete(result.generation, static_cast<int>(result.batch.size()));
+                }
+            }
+            applied++;
         }
+        now = std::chrono::steady_clock::now();
+    }
+    if (applied > 0) {
+        resultApplyStats.recordFrame(applied, std::chrono::duration<double, std::milli>(now - start).count());
+    }
+    return applied;
+}
+
+// Function to Build the Token That Cancels a Weather Flight Once No Current Cycle Waits on It
+static CancellationToken weatherFlightCancellation(const std::string& key) {
+    return CancellationToken([key] { return weatherFlights.newestGeneration(key) != fetchGeneration; });
+}
+
+// Function to Parse the Leader's Response and Hand the Result to Everyone in Its Flight: the
+// body is parsed in one task, and the snapshot derived and the flight completed in another.
+// While the breaker is not closed a failed request is answered with the location's last known data.
+static void completeWeatherFlight(CityHandle city, const std::string& key, const httplib::Response* res,
+    const std::shared_ptr<ParsedBody>& parsed, const std::shared_ptr<const CityWeather>& cached) {
+    onWeatherTask(res, [city, key, parsed, cached](const httplib::Response* res) {
+        std::shared_ptr<ParsedWeather> result = std::make_shared<ParsedWeather>();
+        parseWeatherResponse(city, res, parsed, cached, *result);
+        weatherTasks.submit([city, key, result] {
+            CityWeather& weather = result->weather;
+            if (result->fresh) {
+                weather.weatherData = result->fields.snapshot();
+            }
+            if (weather.received) {
+                rememberWeather(key, weather);
+            }
+            else if (weatherBreaker.state() != BreakerState::Closed) {
+                recallWeather(key, city, weather);
+            }
+            weatherFlights.complete(key, weather);
+        });
+    });
+}
+
+// Function to Create an Asynchronous Client That Reports Its Transfer Sizes
+static AsyncHttpClient* createAsyncClient(AsyncTransport transport) {
+    AsyncHttpClient* client = new AsyncHttpClient(api_host, transport, event_loop_threads, event_loop_max_connections, &hostResolver);
+    client->setTransferObserver([](size_t wireBytes, size_t decodedBytes) { transferStats.record(wireBytes, decodedBytes); });
+    return client;
+}
+
+// Shared Asynchronous Clients, Indexed by AsyncTransport and Started on First Use
+static std::unique_ptr<AsyncHttpClient> asyncClients[2];
+static std::once_flag asyncClientsStarted[2];
+
+// Function to Access the Shared Asynchronous Client for a Transport, Started on First Use
+AsyncHttpClient& asyncClient(AsyncTransport transport) {
+    size_t index = static_cast<size_t>(transport);
+    std::call_once(asyncClientsStarted[index], [transport, index] { asyncClients[index].reset(createAsyncClient(transport)); });
+    return *asyncClients[index];
+}
+
+// Function to Pick the Asynchronous Transport for the Selected Backend; io_uring falls back
+// to epoll, and false means requests run as blocking calls on the thread pool
+static bool activeAsyncTransport(AsyncTransport& transport) {
+    FetchBackend backend = fetchBackend;
+    if (backend == FetchBackend::IoUring && AsyncHttpClient::supported(AsyncTransport::IoUring)) {
+        transport = AsyncTransport::IoUring;
+        return true;
+    }
+    if (backend != FetchBackend::ThreadPool && AsyncHttpClient::supported(AsyncTransport::Epoll)) {
+        transport = AsyncTransport::Epoll;
+        return true;
     }
     return false;
 }
 
-// Function to Load Favorite Cities from a File
-void loadFavorites(std::vector<City>& cities, std::set<std::string>& favorites) {
+// Function to Build the Hint That Tells Whether a City's Row Is on Screen
+static VisibilityHint cityVisibility(CityIndex city) {
+    CityHandle handle = cities.handle(city);
+    return [handle] { return viewportHint.contains(handle); };
+}
+
+// Function to Build the Hint That Tells Whether Any City of a Batch Is on Screen
+static VisibilityHint batchVisibility(const std::vector<CityHandle>& batch) {
+    return [batch] {
+        return std::any_of(batch.begin(), batch.end(), [](CityHandle city) { return viewportHint.contains(city); });
+    };
+}
+
+// Function to Send One Attempt on the Active Backend, Bounded by a Timeout; urgent attempts
+// skip ahead of queued ones on the thread pool
+static void sendOnBackend(const std::string& path, const httplib::Headers& headers, std::chrono::milliseconds timeout,
+    const CancellationToken& cancellation, bool urgent, BodyReceiver receiver, AsyncCallback done) {
+    AsyncTransport transport;
+    if (activeAsyncTransport(transport)) {
+        asyncClient(transport).get(path, headers, done, timeout, receiver);
+        return;
+    }
+    fetchWorkers.submit([path, headers, timeout, cancellation, receiver, done] {
+        httplib::Response res;
+        bool received = pooledGet(path, headers, timeout, cancellation, receiver, res);
+        done(received ? &res : nullptr);
+    }, urgent, [done] { done(nullptr); });
+}
+
+// Streamed Body Parsed on the Task Scheduler: the I/O thread only appends each decoded chunk
+// and goes back to the wire, while one drain task at a time feeds whatever has arrived to the
+// parser, so the chunks are parsed in order without an I/O thread ever running the parser.
+struct ScheduledParse {
+    ScheduledParse() : draining(false), ended(false), failed(false) {}
+
+    std::mutex mutex;
+    std::string pending;           // Arrived but not yet parsed
+    bool draining;                 // A drain task is queued or running
+    bool ended;                    // The transfer is over; onEnd runs after the last chunk is parsed
+    std::function<void()> onEnd;
+    std::atomic<bool> failed;      // Malformed so far, which aborts the transfer
+    StreamedWeather stream;        // Only touched by the drain task
+};
+
+// Function to Feed a Scheduled Parse Everything That Has Arrived, Then Run Its End Once the
+// Transfer Is Over
+static void drainScheduledParse(const std::shared_ptr<ScheduledParse>& parse) {
+    std::string chunk;
+    for (;;) {
+        std::function<void()> onEnd;
+        {
+            std::lock_guard<std::mutex> lock(parse->mutex);
+            if (parse->pending.empty()) {
+                parse->draining = false;
+                if (!parse->ended) {
+                    return; // The next chunk to arrive schedules another drain
+                }
+                onEnd.swap(parse->onEnd);
+            }
+            else {
+                chunk.clear();
+                chunk.swap(parse->pending); // Hands the parsed buffer back for reuse
+            }
+        }
+        if (onEnd) {
+            onEnd();
+            return;
+        }
+        if (!parse->failed && !parse->stream.feed(chunk.data(), chunk.size())) {
+            parse->failed = true;
+        }
+    }
+}
+
+// Function to Queue a Chunk of a Streamed Body for Parsing; false once the body is known to
+// be malformed
+static bool appendScheduledParse(const std::shared_ptr<ScheduledParse>& parse, const char* data, size_t size) {
+    bool schedule;
+    {
+        std::lock_guard<std::mutex> lock(parse->mutex);
+        parse->pending.append(data, size);
+        schedule = !parse->draining;
+        parse->draining = true;
+    }
+    if (schedule) {
+        weatherTasks.submit([parse] { drainScheduledParse(parse); });
+    }
+    return !parse->failed;
+}
+
+// Function to Run a Callback Once Every Chunk of a Streamed Body Has Been Parsed
+static void endScheduledParse(const std::shared_ptr<ScheduledParse>& parse, std::function<void()> onEnd) {
+    bool schedule;
+    {
+        std::lock_guard<std::mutex> lock(parse->mutex);
+        parse->ended = true;
+        parse->onEnd = std::move(onEnd);
+        schedule = !parse->draining;
+        parse->draining = true;
+    }
+    if (schedule) {
+        weatherTasks.submit([parse] { drainScheduledParse(parse); });
+    }
+}
+
+// Function to GET a Path with a Deadline, Retries and Optional Hedging, Guarded by the
+// Endpoint's Circuit Breaker; the callback gets the first usable response, or nullptr once the
+// request has given up or been cancelled. While the breaker is open the request fails at once,
+// and requests already queued behind the rate limiter are released without being sent. While
+// the visibility hint holds, the request goes ahead of other background work at every queue.
+// With a parsed body, each attempt extracts the weather fields of its 200 body while it streams
+// in instead of buffering it, on weatherTasks rather than the I/O thread; the callback then runs
+// on a task worker, finds the fields there, and the response body is empty.
+static void resilientGet(const std::string& path, const httplib::Headers& headers, RequestPriority priority,
+    const VisibilityHint& visible, CircuitBreaker& breaker, const CancellationToken& cancellation,
+    std::shared_ptr<ParsedBody> parsed, AsyncCallback callback) {
+    if (breaker.isOpen()) {
+        callback(nullptr);
+        return;
+    }
+    CircuitBreaker* endpoint = &breaker;
+    CancellationToken guarded([cancellation, endpoint] { return cancellation.cancelled() || endpoint->isOpen(); });
+    resilientFetcher.fetch(priority, [path, headers, visible, endpoint, guarded, parsed](std::chrono::milliseconds timeout, AsyncCallback done) {
+        if (!endpoint->allow()) {
+            done(nullptr); // Half-open with its probes already out
+            return;
+        }
+        auto sent = std::chrono::steady_clock::now();
+        bool urgent = visible && visible();
+        std::shared_ptr<ScheduledParse> parse;
+        BodyReceiver receiver;
+        if (parsed) {
+            parse = std::make_shared<ScheduledParse>();
+            receiver = [parse](const httplib::Response& head) {
+                if (head.status != 200) {
+                    return DecodedSink(); // Error bodies stay buffered for the retry logic
+                }
+                return DecodedSink([parse](const char* data, size_t size) { return appendScheduledParse(parse, data, size); });
+            };
+        }
+        sendOnBackend(path, headers, timeout, guarded, urgent, receiver, [endpoint, guarded, sent, parsed, parse, done](const httplib::Response* res) {
+            auto received = std::chrono::steady_clock::now(); // The upstream's latency, not the parser's
+            auto settle = [endpoint, guarded, sent, received, done](const httplib::Response* res) {
+                if (!res && guarded.cancelled()) {
+                    endpoint->abandon(); // Cancelled before it was sent, so it says nothing about the upstream
+                }
+                else {
+                    bool healthy = res && res->status != 429 && res->status < 500;
+                    endpoint->record(healthy, std::chrono::duration<double, std::milli>(received - sent).count());
+                }
+                done(res);
+            };
+            if (!(res && res->status == 200 && parsed)) {
+                settle(res);
+                return;
+            }
+            std::shared_ptr<httplib::Response> response = std::make_shared<httplib::Response>(*res);
+            endScheduledParse(parse, [parse, parsed, response, settle] {
+                if (parse->failed || !parse->stream.finish()) {
+                    settle(nullptr); // Truncated or malformed document: treated like a transport error
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(parsed->mutex);
+                    if (!parsed->ready) {
+                        parsed->fields = std::move(parse->stream.extractor().fields());
+                        parsed->list.swap(parse->stream.extractor().list());
+                        parsed->ready = true;
+                    }
+                }
+                settle(response.get());
+            });
+        });
+    }, callback, guarded, visible);
+}
+
+// Function to Issue One Resilient GET and Wait for the Response; must not be called from a
+// fetch worker, which may be needed to run the attempts
+static bool fetchAndWait(const std::string& path, const httplib::Headers& headers, RequestPriority priority,
+    const VisibilityHint& visible, CircuitBreaker& breaker, const CancellationToken& cancellation,
+    const std::shared_ptr<ParsedBody>& parsed, httplib::Response& response) {
+    auto done = std::make_shared<std::promise<bool>>();
+    auto result = std::make_shared<httplib::Response>();
+    std::future<bool> received = done->get_future();
+    resilientGet(path, headers, priority, visible, breaker, cancellation, parsed, [done, result](const httplib::Response* res) {
+        if (res) {
+            *result = *res;
+        }
+        done->set_value(res != nullptr);
+    });
+    if (!received.get()) {
+        return false;
+    }
+    response = *result;
+    return true;
+}
+
+// Function to Send the Requests That Fetch Weather for Some Cities on Behalf of a Cycle: one
+// per-city request per location, or group requests for cities with known IDs in batch mode.
+// Uncounted fetches (background refreshes) leave the cycle's progress alone. Cities on screen
+// are submitted first; cities already removed are skipped.
+static void submitWeatherFetches(const std::vector<CityHandle>& requested, const FetchCycle& cycle, RequestPriority priority, bool counted) {
+    std::vector<CityIndex> targets;
+    for (CityHandle handle : requested) {
+        CityIndex city;
+        if (cities.resolve(handle, city)) {
+            targets.push_back(city);
+        }
+        else if (counted) {
+            fetchProgress.complete(cycle.generation());
+        }
+    }
+    std::stable_partition(targets.begin(), targets.end(), [](CityIndex city) { return viewportHint.contains(cities.handle(city)); });
+    uint64_t generation = cycle.generation();
+    auto submitCity = [generation, priority, counted](CityIndex city) {
+        CityHandle handle = cities.handle(city);
+        std::string key = weatherFlightKey(city);
+        if (!joinWeatherFlight(handle, key, generation, counted)) {
+            return; // Same location already in flight: its result is shared with this city
+        }
+        std::shared_ptr<ParsedBody> parsed = streamedBody();
+        std::shared_ptr<const CityWeather> cached;
+        httplib::Headers headers = requestHeadersForCity(handle, cached);
+        resilientGet(weatherPathForCity(city), headers, priority, cityVisibility(city), weatherBreaker,
+            weatherFlightCancellation(key), parsed,
+            [handle, key, parsed, cached](const httplib::Response* res) { completeWeatherFlight(handle, key, res, parsed, cached); });
+    };
+    auto submitBatch = [&cycle, generation, priority, counted](const std::vector<CityHandle>& batch) {
+        std::shared_ptr<ParsedBody> parsed = streamedBody();
+        resilientGet(groupPathForBatch(batch), requestHeaders(), priority, batchVisibility(batch), groupBreaker, cycle.cancellation(),
+            parsed, [batch, generation, counted, parsed](const httplib::Response* res) { queueGroupResponse(batch, res, parsed, generation, counted); });
+    };
+
+    std::vector<CityHandle> batch;
+    for (CityIndex city : targets) {
+        // Cities without a known ID go through the per-city endpoint, which resolves it.
+        if (!batchFetchMode || cities.owmId(city) == 0) {
+            submitCity(city);
+            continue;
+        }
+        batch.push_back(cities.handle(city));
+        if (batch.size() == group_batch_size) {
+            submitBatch(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.empty()) {
+        submitBatch(batch);
+    }
+}
+
+// Function to Supersede the Current Fetch Cycle: its queued requests are skipped and its late
+// results dropped. Results are applied on the UI thread, which checks the generation as it
+// goes, so none of the old cycle's lands after the caller goes on to clear weather data.
+void cancelFetchCycle() {
+    fetchGeneration++;
+}
+
+// Function to Start a New Fetch Cycle for the Selected Cities on the Active Backend; the
+// previous cycle is cancelled first, and each attempt is released by the rate limiter
+// before it is handed to the backend
+FetchCycle fetchWeatherDataForCities(const std::vector<CityHandle>& selected) {
+    FetchCycle cycle(++fetchGeneration);
+    fetchProgress.begin(static_cast<int>(selected.size()), cycle.generation());
+    if (!selected.empty()) {
+        startupTimings.recordFirstFetch();
+    }
+
+    submitWeatherFetches(selected, cycle, RequestPriority::Background, true);
+    return cycle;
+}
+
+// Function to Refresh Some Cities Within the Current Fetch Cycle, Without Superseding It
+void refreshWeatherForCities(const std::vector<CityHandle>& due, RequestPriority priority) {
+    if (!due.empty()) {
+        submitWeatherFetches(due, FetchCycle(fetchGeneration), priority, false);
+    }
+}
+
+// Function to Refresh the Cities the Scheduler Reports Due, at Most refreshes_per_frame per
+// Call; "refresh now" requests go out at interactive priority, ahead of queued refreshes
+void runDueRefreshes() {
+    std::vector<RefreshScheduler::DueRefresh> due = refreshScheduler.takeDue(std::chrono::steady_clock::now(), refreshes_per_frame);
+    if (due.empty()) {
+        return;
+    }
+    std::vector<CityHandle> scheduled;
+    std::vector<CityHandle> manual;
+    for (const auto& refresh : due) {
+        if (cities.contains(refresh.key)) {
+            (refresh.manual ? manual : scheduled).push_back(refresh.key);
+        }
+    }
+    refreshWeatherForCities(manual, RequestPriority::Interactive);
+    refreshWeatherForCities(scheduled, RequestPriority::Background);
+}
+
+// Function to Prepare the Network in the Background While the Window and UI Are Set Up:
+// resolves the API host into the DNS cache, then pre-opens keep-alive connections to it
+void startNetworkWarmUp() {
+    if (warmUpThread.joinable()) {
+        return;
+    }
+    warmUpThread = std::thread([] {
+        double start = startupTimings.sinceLaunchMs();
+        std::string address = hostResolver.resolve(connectionPool.hostname());
+        startupTimings.record(address.empty() ? "DNS lookup (failed)" : "DNS lookup", start);
+        if (address.empty() || warm_connection_count == 0) {
+            return;
+        }
+        start = startupTimings.sinceLaunchMs();
+        size_t opened = connectionPool.warmUp(warm_connection_count, warm_up_timeout);
+        startupTimings.record("Connection warm-up (" + std::to_string(opened) + " of " + std::to_string(warm_connection_count) + " open)", start);
+    });
+}
+
+// Function to Format the Startup Timings as a Table, One Phase per Line
+std::string StartupTimings::report() const {
+    std::string text = "Startup timings (ms since launch):\n";
+    char line[160];
+    for (const Phase& phase : phases()) {
+        std::snprintf(line, sizeof(line), "  %-40s %8.1f - %8.1f (%.1f)\n", phase.name.c_str(), phase.startMs, phase.endMs, phase.endMs - phase.startMs);
+        text += line;
+    }
+    if (firstFetchMs() >= 0.0 && firstWeatherMs() >= 0.0) {
+        std::snprintf(line, sizeof(line), "  %-40s %8.1f - %8.1f (%.1f)\n", "First fetch to first weather", firstFetchMs(), firstWeatherMs(), firstWeatherMs() - firstFetchMs());
+        text += line;
+    }
+    return text;
+}
+
+// Function to Stop All Fetching at Exit: cancels the current cycle, drops scheduled retries
+// and queued requests, aborts requests on the wire and joins the fetch and task workers
+void shutdownFetching() {
+    cancelFetchCycle();
+    resilientFetcher.shutdown();
+    apiRateLimiter.shutdown();
+    connectionPool.stopAll();
+    if (warmUpThread.joinable()) {
+        warmUpThread.join();
+    }
+    fetchWorkers.shutdown();
+    for (auto& client : asyncClients) {
+        if (client) {
+            client->shutdown();
+        }
+    }
+    weatherTasks.shutdown(); // Last: until the I/O threads are joined they may still hand it work
+}
+
+// Function to Look Up the Coordinates of a City Name; a body that is not a list of places
+// with numeric coordinates counts as not found. Nothing here throws, since validateCity()
+// must complete the lookup's flight whatever the upstream sent.
+static GeoLookup geocodeCity(const std::string& cityName) {
+    std::string url = "/geo/1.0/direct?q=" + cityName + "&limit=1&appid=" + api_key;
+
+    GeoLookup lookup = { false, 0.0, 0.0 };
+    httplib::Response res;
+    if (fetchAndWait(url, requestHeaders(), RequestPriority::Interactive, VisibilityHint(), geocodeBreaker,
+        CancellationToken(), nullptr, res) && res.status == 200) {
+        const nlohmann::json data = nlohmann::json::parse(res.body, nullptr, false);
+        if (data.is_array() && !data.empty() && data[0].is_object()) {
+            auto lon = data[0].find("lon");
+            auto lat = data[0].find("lat");
+            if (lon != data[0].end() && lat != data[0].end() && lon->is_number() && lat->is_number()) {
+                lookup.found = true;
+                lookup.lon = lon->get<double>();
+                lookup.lat = lat->get<double>();
+            }
+        }
+    }
+    return lookup;
+}
+
+// Function to Validate if a City Name is Valid; concurrent lookups of the same name (ignoring
+// case and surrounding spaces) share one request, and while the geocoding breaker is not
+// closed a failed lookup falls back to the last coordinates found for the name
+bool validateCity(const std::string& cityName, double& lon, double& lat) {
+    size_t first = cityName.find_first_not_of(" \t");
+    size_t last = cityName.find_last_not_of(" \t");
+    std::string key = "geo:" + (first == std::string::npos ? std::string() : cityName.substr(first, last - first + 1));
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    auto done = std::make_shared<std::promise<GeoLookup>>();
+    std::future<GeoLookup> result = done->get_future();
+    if (geocodeFlights.join(key, [done](const GeoLookup& lookup) { done->set_value(lookup); })) {
+        GeoLookup lookup = geocodeCity(cityName);
+        {
+            std::lock_guard<std::mutex> lock(lastKnownMutex);
+            if (lookup.found) {
+                lastKnownLocations[key] = lookup;
+            }
+            else if (geocodeBreaker.state() != BreakerState::Closed && lastKnownLocations.count(key)) {
+                lookup = lastKnownLocations[key];
+            }
+        }
+        geocodeFlights.complete(key, lookup);
+    }
+
+    GeoLookup lookup = result.get();
+    if (lookup.found) {
+        lon = lookup.lon;
+        lat = lookup.lat;
+    }
+    return lookup.found;
+}
+
+// Function to Load Favorite Cities from a File; only cities missing from the list are looked
+// up, and a favorite whose lookup failed because geocoding is down is kept rather than lost
+void loadFavorites(CityStore& cities, std::set<std::string>& favorites) {
     std::ifstream infile(favorites_file);
     std::string city;
     while (std::getline(infile, city)) {
-        double lon, lat;
-        if (validateCity(city, lon, lat)) {
-            favorites.insert(city);
-            auto it = std::find_if(cities.begin(), cities.end(), [&city](const City& c) { return c.name == city; });
-            if (it == cities.end())
-                cities.push_back({ city, lon, lat, false, nullptr });
+        CityIndex index = cities.find(city);
+        if (index == CityStore::npos) {
+            double lon, lat;
+            if (validateCity(city, lon, lat)) {
+                CityHandle added = cities.add(city, lon, lat);
+                index = added.valid() ? added.slot : CityStore::npos;
+            }
+            else if (geocodeBreaker.state() == BreakerState::Closed) {
+                continue;
+            }
+        }
+        favorites.insert(city);
+        if (index != CityStore::npos) {
+            cities.setFavorite(index, true);
         }
     }
 }
@@ -98,34 +1000,52 @@ void saveFavorites(const std::set<std::string>& favorites) {
 }
 
 // Function to Add Selected Cities to Favorites
-void addFavorites(const std::vector<City>& cities, std::set<std::string>& favorites) {
-    for (const auto& city : cities) {
-        if (city.selected && favorites.find(city.name) == favorites.end()) {
-            favorites.insert(city.name);
-        }
-    }
+void addFavorites(CityStore& cities, std::set<std::string>& favorites) {
+    cities.selection().forEach([&cities, &favorites](CityIndex city) {
+        cities.setFavorite(city, true);
+        favorites.insert(cities.name(city));
+    });
     saveFavorites(favorites);
 }
 
 // Function to Remove Selected Cities from Favorites
-void removeFavorites(const std::vector<City>& cities, std::set<std::string>& favorites) {
-    for (const auto& city : cities) {
-        if (city.selected) {
-            favorites.erase(city.name);
-        }
-    }
+void removeFavorites(CityStore& cities, std::set<std::string>& favorites) {
+    cities.selection().forEach([&cities, &favorites](CityIndex city) {
+        cities.setFavorite(city, false);
+        favorites.erase(cities.name(city));
+    });
     saveFavorites(favorites);
 }
 
-// Function to Filter and Return Only Favorite Cities
-std::vector<City> filterFavorites(const std::vector<City>& cities, const std::set<std::string>& favorites) {
-    std::vector<City> filteredCities;
-    for (const auto& city : cities) {
-        if (favorites.find(city.name) != favorites.end()) {
-            filteredCities.push_back(city);
+// Function to Remove Selected Cities from the List, and from Favorites once no city has their
+// name; results still queued for them no longer resolve, so none lands on a freed slot
+void removeCities(CityStore& cities, std::set<std::string>& favorites) {
+    std::vector<CityIndex> removed = cities.selection().indices();
+    if (removed.empty()) {
+        return;
+    }
+    std::vector<std::string> names;
+    for (CityIndex city : removed) {
+        CityHandle handle = cities.handle(city);
+        names.push_back(cities.name(city));
+        refreshScheduler.untrack(handle);
+        updateCadence.forget(handle);
+        cities.remove(handle);
+    }
+    bool favoritesChanged = false;
+    for (const std::string& name : names) {
+        if (cities.find(name) == CityStore::npos) {
+            favoritesChanged = favorites.erase(name) > 0 || favoritesChanged;
         }
     }
-    return filteredCities;
+    if (favoritesChanged) {
+        saveFavorites(favorites);
+    }
+}
+
+// Function to Filter and Return Only Favorite Cities
+std::vector<CityIndex> filterFavorites(const CityStore& cities) {
+    return cities.favorites().indices();
 }
 
 // Function to Convert Unix Time to HH:MM Format
@@ -138,19 +1058,16 @@ std::string unixToHHMM(int unixTime) {
 }
 
 // Function to Uncheck All Cities
-void uncheckAllCities(std::vector<City>& cities) {
-    for (auto& city : cities) {
-        city.selected = false;
-    }
+void uncheckAllCities(CityStore& cities) {
+    cities.clearSelection();
 }
 
 // Function to Mark a City as Selected Based on Its Name
-bool markCity(const std::string& cityName, std::vector<City>& cities) {
-    for (auto& city : cities) {
-        if (city.name == cityName) {
-            city.selected = true;
-            return true;
-        }
+bool markCity(const std::string& cityName, CityStore& cities) {
+    CityIndex city = cities.find(cityName);
+    if (city == CityStore::npos) {
+        return false;
     }
-    return false;
+    cities.setSelected(city, true);
+    return true;
 }
@@ -0,0 +1,114 @@
+// WorkerPool.cpp
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(size_t threadCount) : running_(0), stopping_(false) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+    workers_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+// Function to Queue a Job for the Next Free Worker; after shutdown the dropped handler runs
+// at once instead
+void WorkerPool::submit(std::function<void()> job, bool urgent, std::function<void()> dropped) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) {
+            Job queued = { std::move(job), std::move(dropped) };
+            (urgent ? urgentJobs_ : jobs_).push_back(std::move(queued));
+            dropped = nullptr;
+        }
+    }
+    if (dropped) {
+        dropped();
+        return;
+    }
+    jobAvailable_.notify_one();
+}
+
+// Function to Block Until the Queue Is Empty and No Job Is Running
+void WorkerPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return urgentJobs_.empty() && jobs_.empty() && running_ == 0; });
+}
+
+// Function to Drop Queued Jobs, Running Their Dropped Handlers, Let Running Jobs Finish and
+// Join All Workers
+void WorkerPool::shutdown() {
+    std::deque<Job> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        dropped.swap(urgentJobs_);
+        for (Job& job : jobs_) {
+            dropped.push_back(std::move(job));
+        }
+        jobs_.clear();
+    }
+    jobAvailable_.notify_all();
+    for (Job& job : dropped) {
+        if (job.dropped) {
+            job.dropped();
+        }
+    }
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    idle_.notify_all();
+}
+
+// Function to Count Jobs Waiting in the Queue
+size_t WorkerPool::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return urgentJobs_.size() + jobs_.size();
+}
+
+// Fetch jobs spend most of their time waiting on the network, so the default runs two
+// workers per hardware thread.
+size_t WorkerPool::defaultThreadCount() {
+    size_t hardwareThreads = std::thread::hardware_concurrency();
+    if (hardwareThreads == 0) {
+        hardwareThreads = 2;
+    }
+    return hardwareThreads * 2;
+}
+
+void WorkerPool::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobAvailable_.wait(lock, [this] { return stopping_ || !urgentJobs_.empty() || !jobs_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            auto& queue = urgentJobs_.empty() ? jobs_ : urgentJobs_;
+            job = std::move(queue.front().run);
+            queue.pop_front();
+            running_++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_--;
+            if (urgentJobs_.empty() && jobs_.empty() && running_ == 0) {
+                idle_.notify_all();
+            }
+        }
+    }
+}
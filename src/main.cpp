@@ -13,7 +13,17 @@
  * @return int Returns 0 on successful execution, -1 on failure.
  */
 int main(int, char**) {
+    // Resolve the API host and open connections while the window and UI are being set up
+    startNetworkWarmUp();
+
+    // Stop fetching on every way out of main(), so no fetch thread is still joinable when
+    // static destruction runs; a second shutdownFetching() does nothing
+    struct FetchingGuard {
+        ~FetchingGuard() { shutdownFetching(); }
+    } fetchingGuard;
+
     // Initialize GLFW library
+    double phaseStart = startupTimings.sinceLaunchMs();
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
@@ -28,14 +38,18 @@ int main(int, char**) {
     }
     glfwMakeContextCurrent(window); // Make the OpenGL context current
     glfwSwapInterval(1); // Enable vsync
+    startupTimings.record("GLFW window", phaseStart);
 
     // Initialize GLEW library
+    phaseStart = startupTimings.sinceLaunchMs();
     if (glewInit() != GLEW_OK) {
         std::cerr << "Failed to initialize GLEW" << std::endl;
         return -1;
     }
+    startupTimings.record("GLEW", phaseStart);
 
     // Initialize ImGui context
+    phaseStart = startupTimings.sinceLaunchMs();
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
@@ -44,22 +58,36 @@ int main(int, char**) {
     // Setup ImGui binding for GLFW and OpenGL
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 130");
+    startupTimings.record("ImGui setup", phaseStart);
 
     // Read API key from file
+    phaseStart = startupTimings.sinceLaunchMs();
     api_key = readApiKeyFromFile("assets/key.txt");
+    if (api_key.empty()) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return -1; // Exit if API key cannot be read
+    }
 
     // Variables to manage application state
     bool fetchWeather = false;
     bool showFavoritesOnly = false;
-    std::vector<std::thread> threads;
     std::set<std::string> favorites;
     loadFavorites(cities, favorites); // Load favorite cities from file
     char cityNameBuffer[128] = ""; // Buffer for new city input
     char markCityBuffer[128] = ""; // Buffer for marking city input
+    startupTimings.record("API key and favorites", phaseStart);
+    phaseStart = startupTimings.sinceLaunchMs();
+    bool firstFrame = true;
+    bool startupReported = false;
 
     // Main application loop
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents(); // Process all pending events
+        applyWeatherResults(); // Store the results workers finished since the last frame, within a budget
 
         // Start a new ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -80,12 +108,32 @@ int main(int, char**) {
         // Left side: City selection
         ImGui::BeginChild("City Selection", ImVec2(ImGui::GetContentRegionAvail().x * 0.6f, 0), true);
         ImGui::Text("Select cities to fetch weather data:");
-        for (auto& city : cities) {
-            if (!showFavoritesOnly || (showFavoritesOnly && favorites.find(city.name) != favorites.end())) {
-                ImGui::Checkbox(city.name.c_str(), &city.selected);
+        std::vector<CityIndex> listed;
+        bool allListed = !showFavoritesOnly && cities.size() == cities.slots(); // Rows are slots, unless some are free
+        if (showFavoritesOnly) {
+            listed = filterFavorites(cities);
+        }
+        else if (!allListed) {
+            listed = cities.live().indices();
+        }
+        // Only the rows in view are drawn; their cities' fetches go first
+        std::vector<CityHandle> visibleCities;
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(allListed ? cities.slots() : listed.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                CityIndex city = allListed ? static_cast<CityIndex>(row) : listed[row];
+                bool selected = cities.selected(city);
+                if (ImGui::Checkbox(cities.name(city).c_str(), &selected)) {
+                    cities.setSelected(city, selected);
+                }
+                visibleCities.push_back(cities.handle(city));
             }
         }
         ImGui::EndChild();
+        if (viewportHint.update(visibleCities)) {
+            apiRateLimiter.reprioritize(); // Queued refreshes follow the rows now on screen
+        }
 
         // Right side: Controls
         ImGui::SameLine();
@@ -96,18 +144,80 @@ int main(int, char**) {
         // Button to fetch weather data for selected cities
         if (ImGui::Button("Fetch Weather Data", buttonSize)) {
             fetchWeather = true;
-            threadsFinished = 0;
-            for (auto& city : cities) {
-                city.weatherData = nullptr; // Clear previous weather data
-            }
-            for (auto& city : cities) {
-                if (city.selected) {
-                    threads.emplace_back(fetchWeatherDataForCity, std::ref(city)); // Fetch weather data in separate threads
+            std::vector<CityHandle> selectedCities;
+            cities.selection().forEach([&selectedCities](CityIndex city) {
+                selectedCities.push_back(cities.handle(city)); // Keep its data so the refresh can be revalidated
+                refreshScheduler.track(selectedCities.back(), auto_refresh_interval); // Kept fresh from now on
+            });
+            transferStats.begin();
+            fetchWeatherDataForCities(selectedCities); // Supersedes any cycle still running
+            for (CityIndex city = 0; city < cities.slots(); city++) {
+                if (cities.alive(city) && !cities.selected(city)) {
+                    cities.clearWeather(city); // Clear previous weather data
+                    refreshScheduler.untrack(cities.handle(city));
+                    updateCadence.forget(cities.handle(city));
                 }
             }
             uncheckAllCities(cities); // Uncheck all cities after fetching data
         }
 
+        // Option to fetch cities with known IDs through the multi-city group endpoint
+        bool batchRequests = batchFetchMode;
+        if (ImGui::Checkbox("Batch requests", &batchRequests)) {
+            batchFetchMode = batchRequests;
+        }
+
+        // Option to request gzip-compressed responses when zlib support is compiled in
+        if (GzipDecoder::available()) {
+            bool compressed = compressedTransfer;
+            if (ImGui::Checkbox("Compressed transfer", &compressed)) {
+                compressedTransfer = compressed;
+            }
+        }
+
+        // Option to parse weather responses while they arrive instead of buffering them first
+        bool streamParse = streamingParse;
+        if (ImGui::Checkbox("Parse while receiving", &streamParse)) {
+            streamingParse = streamParse;
+        }
+
+        // Option to send a duplicate request when one runs longer than the observed p95 latency
+        bool hedgeRequests = resilientFetcher.hedging();
+        if (ImGui::Checkbox("Hedge slow requests", &hedgeRequests)) {
+            resilientFetcher.setHedging(hedgeRequests);
+        }
+
+        // Automatic refresh of the cities on display, each on its own staggered schedule
+        bool autoRefresh = !refreshScheduler.paused();
+        if (ImGui::Checkbox("Auto-refresh", &autoRefresh)) {
+            if (autoRefresh) {
+                refreshScheduler.resume();
+            }
+            else {
+                refreshScheduler.pause();
+            }
+        }
+
+        // Choice of fetch backend; the event loop is only offered where epoll is available
+        if (AsyncHttpClient::supported()) {
+            int backend = static_cast<int>(fetchBackend.load());
+            ImGui::RadioButton("Thread pool", &backend, static_cast<int>(FetchBackend::ThreadPool));
+            ImGui::SameLine();
+            ImGui::RadioButton("Event loop", &backend, static_cast<int>(FetchBackend::EventLoop));
+            if (AsyncHttpClient::supported(AsyncTransport::IoUring)) {
+                ImGui::SameLine();
+                ImGui::RadioButton("io_uring", &backend, static_cast<int>(FetchBackend::IoUring));
+            }
+            fetchBackend = static_cast<FetchBackend>(backend);
+        }
+
+        // Progress of the current fetch cycle
+        if (fetchWeather) {
+            char progressLabel[32];
+            std::snprintf(progressLabel, sizeof(progressLabel), "%d / %d", fetchProgress.completed(), fetchProgress.total());
+            ImGui::ProgressBar(fetchProgress.fraction(), ImVec2(buttonSize.x, 0), progressLabel);
+        }
+
         // Button to add selected cities to favorites
         if (ImGui::Button("Add to Favorites", buttonSize)) {
             addFavorites(cities, favorites);
@@ -120,6 +230,11 @@ int main(int, char**) {
             uncheckAllCities(cities); // Uncheck all cities after removing from favorites
         }
 
+        // Button to remove selected cities from the list; fetches still in flight for them are dropped
+        if (ImGui::Button("Remove Selected Cities", buttonSize)) {
+            removeCities(cities, favorites);
+        }
+
         // Button to toggle between showing all cities and favorite cities only
         if (ImGui::Button(showFavoritesOnly ? "Show All" : "Show Favorites", buttonSize)) {
             showFavoritesOnly = !showFavoritesOnly;
@@ -135,7 +250,7 @@ int main(int, char**) {
             std::string cityName(cityNameBuffer);
             double lon, lat;
             if (validateCity(cityName, lon, lat)) {
-                cities.push_back({ cityName, lon, lat, false, nullptr });
+                cities.add(cityName, lon, lat); // Safe while fetches are in flight: handles stay valid
             }
             cityNameBuffer[0] = '\0'; // Clear the input field
         }
@@ -151,32 +266,164 @@ int main(int, char**) {
             markCityBuffer[0] = '\0'; // Clear the input field
         }
 
-        ImGui::EndChild(); // End the controls child window
+        // Connection reuse statistics for the shared keep-alive pool
+        ConnectionPool::Stats poolStats = connectionPool.stats();
+        ImGui::Separator();
+        ImGui::Text("Connections reused: %.0f%% (%llu of %llu)", poolStats.reuseRate() * 100.0,
+            static_cast<unsigned long long>(poolStats.reused), static_cast<unsigned long long>(poolStats.acquired));
+        ImGui::Text("Idle connections: %zu", poolStats.idle);
 
-        // Handle fetching weather data in background threads
-        if (fetchWeather) {
-            if (threadsFinished == threads.size()) {
-                for (auto& thread : threads) {
-                    if (thread.joinable()) {
-                        thread.join(); // Wait for all threads to finish
-                    }
-                }
-                threads.clear();
-                fetchWeather = false;
+        // Pacing against the API quota
+        RateLimiter::Stats limiterStats = apiRateLimiter.stats();
+        ImGui::Text("Rate limit queue: %zu (%zu interactive, %zu visible)", limiterStats.queued(), limiterStats.queuedInteractive,
+            limiterStats.queuedVisible);
+        ImGui::Text("Average wait: %.0f ms (max %.0f ms)", limiterStats.averageWaitMs, limiterStats.maxWaitMs);
+
+        // Tail latency: how long whole fetch cycles take, and what retries and hedges cost
+        if (fetchProgress.cycleTimes().samples() > 0) {
+            ImGui::Text("Cycle time: p50 %.0f ms, p99 %.0f ms", fetchProgress.cycleTimes().percentile(0.50), fetchProgress.cycleTimes().percentile(0.99));
+        }
+        ResilientFetcher::Stats fetcherStats = resilientFetcher.stats();
+        ImGui::Text("Retries: %llu, hedges: %llu (%llu won), deadline misses: %llu",
+            static_cast<unsigned long long>(fetcherStats.retries), static_cast<unsigned long long>(fetcherStats.hedges),
+            static_cast<unsigned long long>(fetcherStats.hedgeWins), static_cast<unsigned long long>(fetcherStats.deadlineMisses));
+
+        // Background refresh schedule
+        RefreshScheduler::Stats refreshStats = refreshScheduler.stats();
+        if (refreshStats.tracked > 0) {
+            ImGui::Text("Auto-refresh: %zu cities, next in %.0f s%s", refreshStats.tracked, refreshStats.nextDueSeconds,
+                refreshStats.paused ? " (paused)" : "");
+            ImGui::Text("Refreshes: %llu scheduled, %llu manual", static_cast<unsigned long long>(refreshStats.refreshes),
+                static_cast<unsigned long long>(refreshStats.manualRefreshes));
+        }
+
+        // Calls saved by fetching only once a new observation should exist
+        UpdateCadence::Stats cadenceStats = updateCadence.stats(auto_refresh_interval, static_cast<long long>(std::time(nullptr)));
+        if (cadenceStats.fetches > 0) {
+            ImGui::Text("Station cadence: %.0f min median, %llu of %llu fetches found no new observation",
+                cadenceStats.medianCadence / 60.0, static_cast<unsigned long long>(cadenceStats.unchanged),
+                static_cast<unsigned long long>(cadenceStats.fetches));
+            ImGui::Text("Calls %s vs fixed %lld-minute polling: %lld", cadenceStats.avoided() >= 0 ? "avoided" : "added",
+                static_cast<long long>(auto_refresh_interval.count() / 60), std::llabs(cadenceStats.avoided()));
+        }
+
+        // Circuit breaker state per upstream endpoint, with the most recent transition
+        bool degraded = false;
+        for (const CircuitBreaker* breaker : { &weatherBreaker, &groupBreaker, &geocodeBreaker }) {
+            CircuitBreaker::Stats breakerStats = breaker->stats();
+            degraded = degraded || breakerStats.state != BreakerState::Closed;
+            ImGui::Text("Breaker %s: %s (%.0f%% failing, %llu rejected, opened %llu times)", breaker->name().c_str(),
+                CircuitBreaker::stateName(breakerStats.state), breakerStats.failureRate * 100.0,
+                static_cast<unsigned long long>(breakerStats.rejected), static_cast<unsigned long long>(breakerStats.opened));
+            std::vector<CircuitBreaker::Transition> transitions = breaker->transitions();
+            if (!transitions.empty()) {
+                std::time_t at = std::chrono::system_clock::to_time_t(transitions.back().at);
+                char when[16];
+                std::strftime(when, sizeof(when), "%H:%M:%S", std::localtime(&at));
+                ImGui::Text("  %s: %s -> %s (%s)", when, CircuitBreaker::stateName(transitions.back().from),
+                    CircuitBreaker::stateName(transitions.back().to), transitions.back().reason.c_str());
             }
         }
+        if (degraded) {
+            ImGui::TextColored(ImVec4(0.8f, 0.4f, 0.0f, 1.0f), "Weather service degraded: showing last known data");
+        }
+
+        // Requests saved by sharing an identical one that was already in flight
+        if (weatherFlights.coalesced() > 0 || geocodeFlights.coalesced() > 0) {
+            ImGui::Text("Duplicate requests coalesced: %llu", static_cast<unsigned long long>(weatherFlights.coalesced() + geocodeFlights.coalesced()));
+        }
+
+        // Share of conditional refreshes answered with 304 Not Modified
+        if (revalidationStats.conditional() > 0) {
+            ImGui::Text("Revalidated: %.0f%% (%d of %d)", revalidationStats.hitRate() * 100.0,
+                revalidationStats.notModified(), revalidationStats.conditional());
+        }
 
-        // Display weather data for cities
-        for (auto& city : cities) {
-            if (!city.weatherData.is_null()) {
-                ImGui::Text("%s:", city.name.c_str());
-                ImGui::Text("Weather: %s", city.weatherData["weather"][0]["description"].get<std::string>().c_str());
-                ImGui::Text("Temperature: %.2f°C", city.weatherData["main"]["temp"].get<double>() - 273.15);
-                ImGui::Text("Humidity: %d%%", city.weatherData["main"]["humidity"].get<int>());
-                ImGui::Text("Wind Speed: %.2f m/s", city.weatherData["wind"]["speed"].get<double>());
-                ImGui::Text("Sunrise: %s", unixToHHMM(city.weatherData["sys"]["sunrise"].get<int>()).c_str());
-                ImGui::Text("Sunset: %s", unixToHHMM(city.weatherData["sys"]["sunset"].get<int>()).c_str());
-                ImGui::Separator();
+        // Where startup time went, and how long the first fetch took to show weather
+        if (startupTimings.firstWeatherMs() >= 0.0) {
+            ImGui::Text("First weather: %.0f ms after fetch", startupTimings.firstWeatherMs() - startupTimings.firstFetchMs());
+            if (!startupReported) {
+                std::cout << startupTimings.report();
+                startupReported = true;
+            }
+        }
+
+        // How long finished fetches wait for a frame, and what applying them costs
+        if (resultApplyStats.applied() > 0) {
+            ImGui::Text("Results applied: %llu (%llu queued), wait p50 %.1f ms, p99 %.1f ms", resultApplyStats.applied(),
+                resultApplyStats.pending(), resultApplyStats.waits().percentile(0.50), resultApplyStats.waits().percentile(0.99));
+            ImGui::Text("Apply time: %.2f ms for %zu last frame (max %.2f ms)", resultApplyStats.lastFrameMs(),
+                resultApplyStats.lastFrameResults(), resultApplyStats.maxFrameMs());
+        }
+
+        // Parse and derive work run on the task workers instead of the I/O threads
+        TaskScheduler::Stats tasks = weatherTasks.stats();
+        if (tasks.executed > 0) {
+            ImGui::Text("Parse tasks: %llu run on %zu workers, %llu stolen, %zu queued", static_cast<unsigned long long>(tasks.executed),
+                weatherTasks.threadCount(), static_cast<unsigned long long>(tasks.stolen), tasks.pending);
+        }
+
+        // Bandwidth of the last fetch cycle
+        if (transferStats.responses() > 0) {
+            ImGui::Text("Transferred: %.1f KB on wire, %.1f KB decoded", transferStats.wireBytes() / 1024.0, transferStats.decodedBytes() / 1024.0);
+        }
+
+        ImGui::EndChild(); // End the controls child window
+
+        // Handle fetching weather data on the worker pool
+        if (fetchWeather && fetchProgress.finished()) {
+            fetchWeather = false;
+        }
+
+        // Send the background refreshes that have come due
+        runDueRefreshes();
+
+        // Display weather data for cities; only the entries in view are drawn. Each entry keeps
+        // room for every field, so all have the height the clipper measures on the first one.
+        {
+            RcuDomain::ReadGuard weatherGuard(cities.rcu());
+            std::vector<CityIndex> reported;
+            cities.live().forEach([&reported](CityIndex city) {
+                if (cities.hasWeather(city)) {
+                    reported.push_back(city);
+                }
+            });
+            float fieldsHeight = ImGui::GetFrameHeightWithSpacing() + 6 * ImGui::GetTextLineHeightWithSpacing();
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(reported.size()));
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                    CityIndex city = reported[row];
+                    const WeatherSnapshot& weather = *cities.weather(city);
+                    float top = ImGui::GetCursorPosY();
+                    ImGui::PushID(static_cast<int>(city));
+                    ImGui::Text("%s:", cities.name(city).c_str());
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("Refresh now")) {
+                        refreshScheduler.refreshNow(cities.handle(city));
+                    }
+                    ImGui::PopID();
+                    if (weather.has(WeatherFields::Description)) {
+                        ImGui::Text("Weather: %s", weather.description);
+                    }
+                    if (weather.has(WeatherFields::Temperature)) {
+                        ImGui::Text("Temperature: %.2f°C", weather.temperatureC);
+                    }
+                    if (weather.has(WeatherFields::Humidity)) {
+                        ImGui::Text("Humidity: %d%%", weather.humidity);
+                    }
+                    if (weather.has(WeatherFields::WindSpeed)) {
+                        ImGui::Text("Wind Speed: %.2f m/s", weather.windSpeed);
+                    }
+                    if (weather.has(WeatherFields::Sunrise)) {
+                        ImGui::Text("Sunrise: %s", weather.sunriseText);
+                    }
+                    if (weather.has(WeatherFields::Sunset)) {
+                        ImGui::Text("Sunset: %s", weather.sunsetText);
+                    }
+                    ImGui::SetCursorPosY(top + fieldsHeight);
+                    ImGui::Separator();
+                }
             }
         }
 
@@ -190,8 +437,15 @@ int main(int, char**) {
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
         glfwSwapBuffers(window); // Swap front and back buffers
+        if (firstFrame) {
+            startupTimings.record("First frame", phaseStart);
+            firstFrame = false;
+        }
     }
 
+    // Cancel in-flight fetches and join the fetch threads before tearing down the UI
+    shutdownFetching();
+
     // Clean up and terminate the application
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
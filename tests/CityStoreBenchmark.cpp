@@ -0,0 +1,113 @@
+// CityStoreBenchmark.cpp
+//
+// Times the per-frame and per-click operations of the city list on a CityStore of 10k, 100k
+// and 1M cities: adding cities, selecting and counting them, listing favorites, scanning
+// coordinates and temperatures, finding by name, and removing a whole selection.
+// Usage: CityStoreBenchmark [cities...]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "CityStore.h"
+
+namespace {
+
+template <typename F>
+double timeMs(F run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Function to Time Each Operation on a Store of count Cities
+void benchmark(size_t count) {
+    CityStore store;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < count; i++) {
+        names.push_back("City " + std::to_string(i));
+    }
+
+    std::printf("%zu cities\n", count);
+    std::printf("  add all:              %9.3f ms\n", timeMs([&] {
+        for (size_t i = 0; i < count; i++) {
+            store.add(names[i], 0.001 * i, 0.001 * i);
+        }
+    }));
+
+    size_t selected = 0;
+    std::printf("  select all + count:   %9.3f ms\n", timeMs([&] {
+        store.selectAll();
+        selected = store.selection().count();
+    }));
+    size_t visited = 0;
+    std::printf("  walk the selection:   %9.3f ms\n", timeMs([&] {
+        store.selection().forEach([&visited](CityIndex) { visited++; });
+    }));
+
+    for (CityIndex i = 0; i < store.slots(); i += 10) {
+        store.setFavorite(i, true);
+    }
+    std::vector<CityIndex> favorites;
+    std::printf("  list favorites:       %9.3f ms\n", timeMs([&] { favorites = store.favorites().indices(); }));
+
+    double sum = 0.0;
+    std::printf("  scan coordinates:     %9.3f ms\n", timeMs([&] {
+        for (CityIndex i = 0; i < store.slots(); i++) {
+            sum += store.lon(i) + store.lat(i);
+        }
+    }));
+
+    // Every other city has weather, as after a partly failed fetch
+    WeatherSnapshot weather;
+    std::memset(&weather, 0, sizeof(weather));
+    weather.valid = WeatherFields::Temperature;
+    for (CityIndex i = 0; i < store.slots(); i += 2) {
+        weather.temperatureC = static_cast<float>(i % 40);
+        store.setWeather(i, weather);
+    }
+    std::printf("  scan temperatures:    %9.3f ms\n", timeMs([&] {
+        RcuDomain::ReadGuard guard(store.rcu());
+        for (CityIndex i = 0; i < store.slots(); i++) {
+            const WeatherSnapshot* snapshot = store.weather(i);
+            if (snapshot) {
+                sum += snapshot->temperatureC;
+            }
+        }
+    }));
+
+    size_t found = 0;
+    std::printf("  find 1000 by name:    %9.3f ms\n", timeMs([&] {
+        for (size_t i = 0; i < count; i += (count + 999) / 1000) {
+            found += store.find(names[i]) != CityStore::npos;
+        }
+    }));
+
+    std::vector<CityIndex> removed = store.selection().indices();
+    std::printf("  remove the selection: %9.3f ms\n", timeMs([&] {
+        for (CityIndex city : removed) {
+            store.remove(store.handle(city));
+        }
+    }));
+
+    std::printf("(%zu selected, %zu visited, %zu favorites, %zu found, %zu left, checksum %.0f)\n",
+        selected, visited, favorites.size(), found, store.size(), sum);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> counts;
+    for (int arg = 1; arg < argc; arg++) {
+        counts.push_back(std::strtoul(argv[arg], nullptr, 10));
+    }
+    if (counts.empty()) {
+        counts = { 10000, 100000, 1000000 };
+    }
+    for (size_t count : counts) {
+        benchmark(count);
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+// FetchBackendBenchmark.cpp
+//
+// Times a per-city fetch cycle over many cities on each fetch backend against the mock server,
+// which holds every response for a fixed latency so the cycle is bound by how many requests a
+// backend keeps in flight rather than by the loopback round trip. The server's data changes
+// and the weather is cleared before every cycle, so no request is answered from a validator
+// and a cycle only counts when every city was fetched.
+// Usage: FetchBackendBenchmark [cities] [latency ms] [cycles]
+
+#include <algorithm>
+#include <cstdlib>
+#include "FetchHarness.h"
+
+int main(int argc, char** argv) {
+    size_t cityCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 128;
+    long latency = argc > 2 ? std::strtol(argv[2], nullptr, 10) : 5;
+    int cycles = argc > 3 ? std::atoi(argv[3]) : 3;
+
+    // One server thread per connection the event loop may open for the cities
+    MockServer server(cityCount + 16);
+    server.setDelay(std::chrono::milliseconds(latency));
+    api_key = "test";
+    apiRateLimiter.configure(0, 1); // No pacing against the mock server
+    batchFetchMode = false;
+
+    std::printf("%zu cities, %ld ms server latency, best of %d cycles\n", cityCount, latency, cycles);
+    const FetchBackend backends[] = { FetchBackend::ThreadPool, FetchBackend::EventLoop, FetchBackend::IoUring };
+    const char* backendNames[] = { "thread pool", "event loop (epoll)", "event loop (io_uring)" };
+    for (int b = 0; b < 3; b++) {
+        if (backends[b] == FetchBackend::IoUring && !AsyncHttpClient::supported(AsyncTransport::IoUring)) {
+            std::printf("  %-22s not supported here\n", backendNames[b]);
+            continue;
+        }
+        fetchBackend = backends[b];
+        std::vector<CityHandle> all = addTestCities(cityCount);
+        double best = 0.0;
+        bool complete = true;
+        for (int cycle = 0; cycle < cycles && complete; cycle++) {
+            for (CityIndex city = 0; city < cities.slots(); city++) {
+                cities.clearWeather(city);
+            }
+            server.bumpVersion();
+            int requestsBefore = server.weatherRequests();
+            auto start = std::chrono::steady_clock::now();
+            complete = runFetchCycle(all, std::chrono::seconds(120));
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            size_t fetched = countWithMockWeather(all);
+            if (!complete || fetched != cityCount) {
+                std::printf("  %-22s cycle failed: %zu of %zu cities fetched, %d requests reached the server\n", backendNames[b],
+                    fetched, cityCount, server.weatherRequests() - requestsBefore);
+                complete = false;
+            }
+            best = cycle == 0 ? ms : std::min(best, ms);
+        }
+        if (complete) {
+            std::printf("  %-22s %9.1f ms per cycle\n", backendNames[b], best);
+        }
+    }
+
+    shutdownFetching();
+    return 0;
+}
@@ -0,0 +1,65 @@
+// FetchHarness.h
+
+#ifndef FETCHHARNESS_H
+#define FETCHHARNESS_H
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "WeatherForecast.h"
+#include "MockServer.h"
+
+// Function to Report a Failed Check; returns 1 so failures can be summed into an exit code
+inline int check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+// Function to Replace the City List With count Cities at Distinct Locations, So Every City
+// Gets Its Own Request and Its Own Mock City ID
+inline std::vector<CityHandle> addTestCities(size_t count) {
+    cities.clear();
+    std::vector<CityHandle> added;
+    for (size_t i = 0; i < count; i++) {
+        added.push_back(cities.add("City " + std::to_string(i), 2.0 + 0.01 * i, 1.0 + 0.01 * i));
+    }
+    return added;
+}
+
+// Function to Run One Fetch Cycle the Way the UI Does: start it, then apply the finished
+// results once per frame until the cycle completes; false if it does not within timeout
+inline bool runFetchCycle(const std::vector<CityHandle>& selected, std::chrono::seconds timeout = std::chrono::seconds(30)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    fetchWeatherDataForCities(selected);
+    while (!fetchProgress.finished()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        applyWeatherResults();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    applyWeatherResults();
+    return true;
+}
+
+// Function to Count the Cities Holding the Weather the Mock Server Sends; removed cities
+// count as not holding it
+inline size_t countWithMockWeather(const std::vector<CityHandle>& handles) {
+    RcuDomain::ReadGuard guard(cities.rcu());
+    size_t count = 0;
+    for (CityHandle handle : handles) {
+        CityIndex city;
+        const WeatherSnapshot* weather = cities.resolve(handle, city) ? cities.weather(city) : nullptr;
+        if (weather && std::string(weather->description) == "clear sky" && weather->temperatureC > 19.9f && weather->temperatureC < 20.1f) {
+            count++;
+        }
+    }
+    return count;
+}
+
+#endif // FETCHHARNESS_H
@@ -0,0 +1,82 @@
+// GeocodeTest.cpp
+//
+// Looks city names up with validateCity() against the mock server on each backend: a name
+// with a space must reach the server intact and be found, and an unknown name must not be.
+// Malformed answers must count as not found and must not leave the name's lookup in flight,
+// so a second lookup of the same name, or two at once, still returns.
+
+#include <future>
+#include <memory>
+#include "FetchHarness.h"
+
+namespace {
+
+const std::chrono::seconds kLookupLimit(10);
+
+struct Lookup {
+    bool found;
+    double lon;
+    double lat;
+};
+
+// Function to Validate a Name on Another Thread, Which Is Left Behind if It Never Returns
+std::future<Lookup> startLookup(const std::string& name) {
+    auto outcome = std::make_shared<std::promise<Lookup>>();
+    std::future<Lookup> result = outcome->get_future();
+    std::thread([name, outcome] {
+        Lookup looked = { false, 0.0, 0.0 };
+        looked.found = validateCity(name, looked.lon, looked.lat);
+        outcome->set_value(looked);
+    }).detach();
+    return result;
+}
+
+// Function to Wait for a Lookup; false if it did not return within kLookupLimit
+bool finished(std::future<Lookup>& result, Lookup& looked) {
+    if (result.wait_for(kLookupLimit) != std::future_status::ready) {
+        return false;
+    }
+    looked = result.get();
+    return true;
+}
+
+} // namespace
+
+int main() {
+    MockServer server;
+    api_key = "test";
+    apiRateLimiter.configure(0, 1); // No pacing against the mock server
+    int failures = 0;
+
+    const FetchBackend backends[] = { FetchBackend::ThreadPool, FetchBackend::EventLoop, FetchBackend::IoUring };
+    const char* backendNames[] = { "thread pool", "event loop (epoll)", "event loop (io_uring)" };
+    for (int b = 0; b < 3; b++) {
+        if (backends[b] == FetchBackend::IoUring && !AsyncHttpClient::supported(AsyncTransport::IoUring)) {
+            std::printf("%s not supported here\n", backendNames[b]);
+            continue;
+        }
+        fetchBackend = backends[b];
+        std::string backend = backendNames[b];
+        Lookup looked = { false, 0.0, 0.0 };
+
+        std::future<Lookup> spaced = startLookup("San Francisco");
+        failures += check(finished(spaced, looked), backend + ": lookup with a space returns");
+        failures += check(looked.found && looked.lon == 2.5 && looked.lat == 1.5, backend + ": name with a space found");
+        std::future<Lookup> unknown = startLookup("Atlantis 2");
+        failures += check(finished(unknown, looked) && !looked.found, backend + ": unknown name not found");
+
+        for (const char* malformed : { "Garbled", "Object", "No Lon" }) {
+            std::string what = backend + ": malformed answer for \"" + malformed + "\"";
+            std::future<Lookup> first = startLookup(malformed);
+            std::future<Lookup> second = startLookup(malformed); // Usually joins the first one's flight
+            failures += check(finished(first, looked) && !looked.found, what + " not found");
+            failures += check(finished(second, looked) && !looked.found, what + " not found by a concurrent lookup");
+            std::future<Lookup> again = startLookup(malformed);
+            failures += check(finished(again, looked) && !looked.found, what + " looked up again");
+        }
+    }
+
+    shutdownFetching();
+    std::printf(failures == 0 ? "ok\n" : "%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+// GroupFetchTest.cpp
+//
+// Fetches a city list per city, then again in batch mode, against the mock server on each
+// backend, and checks that batch mode sends one group request per group_batch_size cities
+// with known IDs instead of one request per city, and fills in the same weather.
+
+#include "FetchHarness.h"
+
+int main() {
+    const size_t cityCount = 3 * group_batch_size;
+    MockServer server;
+    api_key = "test";
+    apiRateLimiter.configure(0, 1); // No pacing against the mock server
+    int failures = 0;
+
+    const FetchBackend backends[] = { FetchBackend::ThreadPool, FetchBackend::EventLoop };
+    const char* backendNames[] = { "thread pool", "event loop" };
+    for (int b = 0; b < 2; b++) {
+        fetchBackend = backends[b];
+        std::vector<CityHandle> all = addTestCities(cityCount);
+
+        batchFetchMode = false;
+        int weatherBefore = server.weatherRequests();
+        int groupBefore = server.groupRequests();
+        failures += check(runFetchCycle(all), std::string(backendNames[b]) + ": per-city cycle finishes");
+        int perCity = server.weatherRequests() - weatherBefore;
+        failures += check(perCity == static_cast<int>(cityCount), std::string(backendNames[b]) + ": one request per city");
+        failures += check(server.groupRequests() == groupBefore, std::string(backendNames[b]) + ": no group request per city");
+        failures += check(countWithMockWeather(all) == cityCount, std::string(backendNames[b]) + ": every city has weather per city");
+        for (CityHandle handle : all) {
+            CityIndex city;
+            if (cities.resolve(handle, city)) {
+                failures += check(cities.owmId(city) == MockServer::idForLatitude(cities.lat(city)), "city ID learned from its response");
+                cities.clearWeather(city);
+            }
+        }
+
+        batchFetchMode = true;
+        weatherBefore = server.weatherRequests();
+        groupBefore = server.groupRequests();
+        failures += check(runFetchCycle(all), std::string(backendNames[b]) + ": batch cycle finishes");
+        int grouped = server.groupRequests() - groupBefore;
+        failures += check(grouped == static_cast<int>((cityCount + group_batch_size - 1) / group_batch_size),
+            std::string(backendNames[b]) + ": one group request per batch");
+        failures += check(server.weatherRequests() == weatherBefore, std::string(backendNames[b]) + ": no per-city request in batch mode");
+        failures += check(countWithMockWeather(all) == cityCount, std::string(backendNames[b]) + ": every city has weather from the group");
+
+        std::printf("%s: %zu cities, %d per-city requests, %d group requests\n", backendNames[b], cityCount, perCity, grouped);
+    }
+
+    shutdownFetching();
+    std::printf(failures == 0 ? "ok\n" : "%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// HedgingBenchmark.cpp
+//
+// Runs many per-city fetch cycles against the mock server while it holds every nth response
+// for a latency spike, and optionally fails every nth one, and reports the p50 and p99 time
+// for a cycle to complete with hedging off and then on. Without hedging a cycle that hits a
+// spike waits it out; with hedging the slow request is duplicated once it outlives the p95
+// latency. Failed requests are retried after the app's backoff either way.
+// Usage: HedgingBenchmark [cities] [cycles] [spike every n] [spike ms] [fail every n]
+
+#include <algorithm>
+#include <cstdlib>
+#include "FetchHarness.h"
+
+namespace {
+
+double percentile(std::vector<double> samples, double fraction) {
+    std::sort(samples.begin(), samples.end());
+    return samples[std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()))];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t cityCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50;
+    int cycles = argc > 2 ? std::atoi(argv[2]) : 30;
+    int spikeEvery = argc > 3 ? std::atoi(argv[3]) : 40;
+    long spikeMs = argc > 4 ? std::strtol(argv[4], nullptr, 10) : 300;
+    int failEvery = argc > 5 ? std::atoi(argv[5]) : 0;
+
+    MockServer server(cityCount + 16);
+    server.setDelay(std::chrono::milliseconds(5));
+    api_key = "test";
+    apiRateLimiter.configure(0, 1); // No pacing against the mock server
+    batchFetchMode = false;
+    fetchBackend = FetchBackend::EventLoop;
+    std::vector<CityHandle> all = addTestCities(cityCount);
+
+    // Warm-up without spikes, so the fetcher has the latency samples hedging needs
+    for (int cycle = 0; cycle < 3; cycle++) {
+        server.bumpVersion();
+        runFetchCycle(all);
+    }
+    server.setSpike(spikeEvery, std::chrono::milliseconds(spikeMs));
+    server.setFailure(failEvery, 503);
+
+    std::printf("%zu cities, %d cycles, 5 ms latency, +%ld ms spike every %d requests, 503 every %d requests\n",
+        cityCount, cycles, spikeMs, spikeEvery, failEvery);
+    for (bool hedging : { false, true }) {
+        resilientFetcher.setHedging(hedging);
+        ResilientFetcher::Stats before = resilientFetcher.stats();
+        int spikesBefore = server.spikes();
+        std::vector<double> times;
+        for (int cycle = 0; cycle < cycles; cycle++) {
+            for (CityIndex city = 0; city < cities.slots(); city++) {
+                cities.clearWeather(city);
+            }
+            server.bumpVersion();
+            auto start = std::chrono::steady_clock::now();
+            if (!runFetchCycle(all, std::chrono::seconds(60))) {
+                std::printf("  cycle did not finish\n");
+                break;
+            }
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        if (times.empty()) {
+            continue;
+        }
+        ResilientFetcher::Stats after = resilientFetcher.stats();
+        std::printf("  hedging %-3s  p50 %7.1f ms  p99 %7.1f ms  (%d spikes, %llu hedges, %llu won, %llu retries)\n",
+            hedging ? "on" : "off", percentile(times, 0.50), percentile(times, 0.99), server.spikes() - spikesBefore,
+            static_cast<unsigned long long>(after.hedges - before.hedges),
+            static_cast<unsigned long long>(after.hedgeWins - before.hedgeWins),
+            static_cast<unsigned long long>(after.retries - before.retries));
+    }
+
+    shutdownFetching();
+    return 0;
+}
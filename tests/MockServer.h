@@ -0,0 +1,159 @@
+// MockServer.h
+
+#ifndef MOCKSERVER_H
+#define MOCKSERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <httplib.h>
+#include <json.hpp>
+
+// Mock Server: Stands in for the OpenWeatherMap API on the host the test build points api_host
+// at (WEATHERFORECAST_TEST_HOST:WEATHERFORECAST_TEST_PORT). It serves the per-city, group and
+// geocoding endpoints, counts the requests each receives, and tags every weather response with
+// an ETag that changes when version() is bumped, answering a matching If-None-Match with a 304.
+// A city's ID is derived from its latitude, so the group endpoint can answer for the IDs that
+// per-city responses handed out. Every response can be held for a fixed latency, every nth
+// one for an extra spike, and every nth one can fail with an error status instead.
+//
+// httplib serves each keep-alive connection on one thread until it goes idle, so threads must
+// cover the connections the backend under test opens at once; the test build also raises
+// CPPHTTPLIB_LISTEN_BACKLOG so a burst of connects is not dropped.
+class MockServer {
+public:
+    explicit MockServer(size_t threads = 64)
+        : version_(1), delayMs_(0), spikeEvery_(0), spikeMs_(0), failEvery_(0), failStatus_(500), served_(0),
+          weather_(0), group_(0), geocode_(0), notModified_(0), spikes_(0), failures_(0) {
+        server_.new_task_queue = [threads] { return new httplib::ThreadPool(threads); };
+        server_.set_pre_routing_handler([this](const httplib::Request&, httplib::Response& res) {
+            long long n = ++served_;
+            long long delay = delayMs_;
+            if (spikeEvery_ > 0 && n % spikeEvery_ == 0) {
+                spikes_++;
+                delay += spikeMs_;
+            }
+            if (delay > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+            }
+            if (failEvery_ > 0 && n % failEvery_ == 0) {
+                failures_++;
+                res.status = failStatus_;
+                return httplib::Server::HandlerResponse::Handled;
+            }
+            return httplib::Server::HandlerResponse::Unhandled;
+        });
+        server_.Get("/data/2.5/weather", [this](const httplib::Request& req, httplib::Response& res) {
+            weather_++;
+            double lat = std::stod(req.get_param_value("lat"));
+            double lon = std::stod(req.get_param_value("lon"));
+            int id = idForLatitude(lat);
+            std::string etag = "\"" + std::to_string(id) + "-v" + std::to_string(version_.load()) + "\"";
+            res.set_header("ETag", etag);
+            if (req.get_header_value("If-None-Match") == etag) {
+                notModified_++;
+                res.status = 304;
+                return;
+            }
+            res.set_content(entry(id, lat, lon).dump(), "application/json");
+        });
+        server_.Get("/data/2.5/group", [this](const httplib::Request& req, httplib::Response& res) {
+            group_++;
+            nlohmann::json list = nlohmann::json::array();
+            std::stringstream ids(req.get_param_value("id"));
+            std::string id;
+            while (std::getline(ids, id, ',')) {
+                list.push_back(entry(std::stoi(id), 0.0, 0.0));
+            }
+            nlohmann::json body = { { "cnt", list.size() }, { "list", list } };
+            res.set_content(body.dump(), "application/json");
+        });
+        // Places are only found for names without a digit, so tests can look up unknown ones;
+        // the names "Garbled", "Object" and "No Lon" get malformed answers
+        server_.Get("/geo/1.0/direct", [this](const httplib::Request& req, httplib::Response& res) {
+            geocode_++;
+            std::string name = req.get_param_value("q");
+            std::string body;
+            if (name == "Garbled") {
+                body = "[{\"lat\": 1.5, \"lon\"";
+            }
+            else if (name == "Object") {
+                body = "{\"lat\": 1.5, \"lon\": 2.5}";
+            }
+            else if (name == "No Lon") {
+                body = "[{\"lat\": 1.5}]";
+            }
+            else {
+                nlohmann::json places = nlohmann::json::array();
+                if (!name.empty() && name.find_first_of("0123456789") == std::string::npos) {
+                    places.push_back({ { "name", name }, { "lat", 1.5 }, { "lon", 2.5 } });
+                }
+                body = places.dump();
+            }
+            res.set_content(body, "application/json");
+        });
+        server_.bind_to_port(WEATHERFORECAST_TEST_HOST, WEATHERFORECAST_TEST_PORT);
+        thread_ = std::thread([this] { server_.listen_after_bind(); });
+        while (!server_.is_running()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    ~MockServer() {
+        server_.stop();
+        thread_.join();
+    }
+
+    // A city's weather object, shaped like a current-weather response
+    static nlohmann::json entry(int id, double lat, double lon) {
+        return {
+            { "id", id },
+            { "dt", 1700000000 },
+            { "name", "City " + std::to_string(id) },
+            { "weather", { { { "description", "clear sky" } } } },
+            { "main", { { "temp", 293.15 }, { "humidity", 40 } } },
+            { "wind", { { "speed", 3.5 } } },
+            { "sys", { { "sunrise", 1700000000 }, { "sunset", 1700040000 } } },
+            { "coord", { { "lat", lat }, { "lon", lon } } }
+        };
+    }
+    static int idForLatitude(double lat) { return 1000 + static_cast<int>(std::lround(std::fabs(lat) * 100)); }
+
+    void bumpVersion() { version_++; } // Every city's data changes
+    void setDelay(std::chrono::milliseconds delay) { delayMs_ = delay.count(); }
+    // Every nth request served is held for extra on top of the delay; 0 turns spikes off
+    void setSpike(int every, std::chrono::milliseconds extra) { spikeMs_ = extra.count(); spikeEvery_ = every; }
+    // Every nth request served fails with status; 0 turns failures off
+    void setFailure(int every, int status = 500) { failStatus_ = status; failEvery_ = every; }
+
+    int weatherRequests() const { return weather_; }
+    int groupRequests() const { return group_; }
+    int geocodeRequests() const { return geocode_; }
+    int notModified() const { return notModified_; }
+    int spikes() const { return spikes_; }
+    int failures() const { return failures_; }
+
+private:
+    MockServer(const MockServer&) = delete;
+    MockServer& operator=(const MockServer&) = delete;
+
+    httplib::Server server_;
+    std::thread thread_;
+    std::atomic<int> version_;
+    std::atomic<long long> delayMs_;
+    std::atomic<int> spikeEvery_;
+    std::atomic<long long> spikeMs_;
+    std::atomic<int> failEvery_;
+    std::atomic<int> failStatus_;
+    std::atomic<long long> served_;
+    std::atomic<int> weather_;
+    std::atomic<int> group_;
+    std::atomic<int> geocode_;
+    std::atomic<int> notModified_;
+    std::atomic<int> spikes_;
+    std::atomic<int> failures_;
+};
+
+#endif // MOCKSERVER_H
@@ -0,0 +1,153 @@
+// ParseBenchmark.cpp
+//
+// Times the three ways a weather body can become WeatherFields: building a nlohmann DOM and
+// reading the fields from it, running the SAX field extractor over the complete body, and
+// feeding the streaming parser the body in socket-sized pieces as it would arrive. Reports
+// time and heap allocations per body; allocations are counted by replacing operator new.
+// Usage: ParseBenchmark [bodies]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <json.hpp>
+#include "WeatherFields.h"
+
+namespace {
+std::atomic<unsigned long long> allocations(0);
+} // namespace
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const size_t kPieceSize = 1460; // One TCP segment of payload
+
+// A current-weather body with every field OpenWeatherMap sends, not only the ones the app uses
+nlohmann::json weatherObject(int id) {
+    return {
+        { "coord", { { "lon", 2.35 }, { "lat", 48.85 } } },
+        { "weather", { { { "id", 800 }, { "main", "Clear" }, { "description", "clear sky" }, { "icon", "01d" } } } },
+        { "base", "stations" },
+        { "main", { { "temp", 293.15 }, { "feels_like", 292.6 }, { "temp_min", 291.2 }, { "temp_max", 294.8 },
+            { "pressure", 1016 }, { "humidity", 40 }, { "sea_level", 1016 }, { "grnd_level", 1006 } } },
+        { "visibility", 10000 },
+        { "wind", { { "speed", 3.5 }, { "deg", 240 }, { "gust", 6.1 } } },
+        { "clouds", { { "all", 0 } } },
+        { "dt", 1700000000 + id },
+        { "sys", { { "type", 2 }, { "id", 2041230 }, { "country", "FR" }, { "sunrise", 1700000000 }, { "sunset", 1700040000 } } },
+        { "timezone", 3600 },
+        { "id", id },
+        { "name", "City " + std::to_string(id) },
+        { "cod", 200 }
+    };
+}
+
+// Reads the fields the way the app did before the extractor, from a full DOM
+void fieldsFromDom(const std::string& body, WeatherFields& fields) {
+    nlohmann::json data = nlohmann::json::parse(body);
+    fields.id = data["id"];
+    fields.dt = data["dt"];
+    fields.description = data["weather"][0]["description"];
+    fields.temp = data["main"]["temp"];
+    fields.humidity = data["main"]["humidity"];
+    fields.windSpeed = data["wind"]["speed"];
+    fields.sunrise = data["sys"]["sunrise"];
+    fields.sunset = data["sys"]["sunset"];
+}
+
+struct Measured {
+    double us;     // Per body
+    double allocs; // Per body
+};
+
+template <typename F>
+Measured measureEach(const std::vector<std::string>& bodies, F parse) {
+    unsigned long long allocated = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& body : bodies) {
+        parse(body);
+    }
+    Measured measured = { std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / bodies.size(),
+        static_cast<double>(allocations - allocated) / bodies.size() };
+    return measured;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    std::vector<std::string> single;
+    std::vector<std::string> groups;
+    for (size_t i = 0; i < count; i++) {
+        single.push_back(weatherObject(static_cast<int>(i)).dump());
+    }
+    for (size_t i = 0; i < count / 20; i++) {
+        nlohmann::json list = nlohmann::json::array();
+        for (int k = 0; k < 20; k++) {
+            list.push_back(weatherObject(static_cast<int>(i * 20 + k)));
+        }
+        groups.push_back(nlohmann::json({ { "cnt", 20 }, { "list", list } }).dump());
+    }
+
+    long long checksum = 0;
+    Measured dom = measureEach(single, [&checksum](const std::string& body) {
+        WeatherFields fields;
+        fieldsFromDom(body, fields);
+        checksum += fields.humidity;
+    });
+    Measured sax = measureEach(single, [&checksum](const std::string& body) {
+        WeatherFieldExtractor extractor;
+        extractWeatherFields(body, extractor);
+        checksum += extractor.fields().humidity;
+    });
+    Measured streamed = measureEach(single, [&checksum](const std::string& body) {
+        StreamedWeather stream;
+        for (size_t offset = 0; offset < body.size(); offset += kPieceSize) {
+            stream.feed(body.data() + offset, std::min(kPieceSize, body.size() - offset));
+        }
+        stream.finish();
+        checksum += stream.extractor().fields().humidity;
+    });
+    Measured groupDom = measureEach(groups, [&checksum](const std::string& body) {
+        nlohmann::json data = nlohmann::json::parse(body);
+        for (const auto& entry : data["list"]) {
+            checksum += entry["main"]["humidity"].get<int>();
+        }
+    });
+    Measured groupStreamed = measureEach(groups, [&checksum](const std::string& body) {
+        StreamedWeather stream;
+        for (size_t offset = 0; offset < body.size(); offset += kPieceSize) {
+            stream.feed(body.data() + offset, std::min(kPieceSize, body.size() - offset));
+        }
+        stream.finish();
+        for (const WeatherFields& fields : stream.extractor().list()) {
+            checksum += fields.humidity;
+        }
+    });
+
+    std::printf("%zu per-city bodies of %zu bytes, %zu group bodies of %zu bytes\n", single.size(), single[0].size(),
+        groups.size(), groups.empty() ? 0 : groups[0].size());
+    std::printf("  per-city, DOM then fields:       %7.2f us/body %7.1f allocations/body\n", dom.us, dom.allocs);
+    std::printf("  per-city, SAX field extractor:   %7.2f us/body %7.1f allocations/body\n", sax.us, sax.allocs);
+    std::printf("  per-city, streamed in %zu B:   %7.2f us/body %7.1f allocations/body\n", kPieceSize, streamed.us, streamed.allocs);
+    std::printf("  group, DOM:                      %7.2f us/body %7.1f allocations/body\n", groupDom.us, groupDom.allocs);
+    std::printf("  group, streamed:                 %7.2f us/body %7.1f allocations/body\n", groupStreamed.us, groupStreamed.allocs);
+    std::printf("(checksum %lld)\n", checksum);
+    return 0;
+}
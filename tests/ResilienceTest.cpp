@@ -0,0 +1,177 @@
+// ResilienceTest.cpp
+//
+// Drives ResilientFetcher with senders that fail, stall or answer late, and checks that the
+// attempt limit, the retry budget and the deadline bound how many attempts a request makes
+// and how long it takes, and that a hedge answers a request whose first attempt stalled.
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include "FetchHarness.h"
+
+namespace {
+
+struct Outcome {
+    bool finished;  // The callback ran within the test's limit
+    bool answered;  // It got a response rather than nullptr
+    int status;
+    double ms;
+};
+
+RetryOptions retryOptions(std::chrono::milliseconds deadline, int attempts, double budgetRatio, double budgetCap,
+    bool hedging = false) {
+    RetryOptions options = { deadline, attempts, std::chrono::milliseconds(1), std::chrono::milliseconds(2),
+        budgetRatio, budgetCap, hedging, 0.95, 20 };
+    return options;
+}
+
+// Function to Run One Request Through a Fetcher and Wait for Its Callback
+Outcome fetchOnce(ResilientFetcher& fetcher, AttemptSender send) {
+    auto done = std::make_shared<std::promise<Outcome>>();
+    std::future<Outcome> result = done->get_future();
+    auto start = std::chrono::steady_clock::now();
+    fetcher.fetch(RequestPriority::Background, send, [done, start](const httplib::Response* res) {
+        Outcome outcome = { true, res != nullptr, res ? res->status : 0,
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() };
+        done->set_value(outcome);
+    });
+    if (result.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+        Outcome outcome = { false, false, 0, 0.0 };
+        return outcome;
+    }
+    return result.get();
+}
+
+// Stalled Attempts: Holds the callbacks of attempts that never answer, to release at the end
+struct Stalled {
+    std::mutex mutex;
+    std::vector<AsyncCallback> callbacks;
+
+    void hold(AsyncCallback done) {
+        std::lock_guard<std::mutex> lock(mutex);
+        callbacks.push_back(done);
+    }
+    void release() {
+        std::vector<AsyncCallback> held;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            held.swap(callbacks);
+        }
+        for (auto& done : held) {
+            done(nullptr);
+        }
+    }
+};
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    std::atomic<int> attempts(0);
+    AttemptSender failing = [&attempts](std::chrono::milliseconds, AsyncCallback done) {
+        attempts++;
+        done(nullptr);
+    };
+    AttemptSender unavailable = [&attempts](std::chrono::milliseconds, AsyncCallback done) {
+        attempts++;
+        httplib::Response res;
+        res.status = 503;
+        done(&res);
+    };
+
+    // Attempt limit: with budget to spare, a failing request makes exactly maxAttempts attempts
+    {
+        ResilientFetcher fetcher(retryOptions(std::chrono::milliseconds(5000), 3, 1.0, 100.0));
+        attempts = 0;
+        bool allFailed = true;
+        for (int i = 0; i < 10; i++) {
+            Outcome outcome = fetchOnce(fetcher, failing);
+            allFailed = allFailed && outcome.finished && !outcome.answered;
+        }
+        failures += check(allFailed, "failing requests give up with nullptr");
+        failures += check(attempts == 30, "3 attempts per failing request, got " + std::to_string(attempts.load()));
+        attempts = 0;
+        Outcome outcome = fetchOnce(fetcher, unavailable);
+        failures += check(outcome.answered && outcome.status == 503, "the last error response is handed back");
+        failures += check(attempts == 3, "3 attempts for a request answered 503");
+    }
+
+    // Retry budget: 20 failing requests earn 0.1 retry each on top of a reserve of 2, so at
+    // most 4 retries go out however many attempts are allowed
+    {
+        ResilientFetcher fetcher(retryOptions(std::chrono::milliseconds(5000), 3, 0.1, 2.0));
+        attempts = 0;
+        for (int i = 0; i < 20; i++) {
+            fetchOnce(fetcher, failing);
+        }
+        ResilientFetcher::Stats stats = fetcher.stats();
+        failures += check(stats.retries <= 4, "budget bounds retries to 4, got " + std::to_string(stats.retries));
+        failures += check(attempts <= 24, "budget bounds attempts to 24, got " + std::to_string(attempts.load()));
+        failures += check(stats.budgetDenied > 0, "retries were denied by the budget");
+    }
+
+    // Deadline: a stalled attempt is given the deadline as its timeout, and the request gives
+    // up when the deadline passes instead of waiting on the attempt
+    {
+        ResilientFetcher fetcher(retryOptions(std::chrono::milliseconds(300), 3, 1.0, 100.0));
+        Stalled stalled;
+        std::chrono::milliseconds timeout(0);
+        Outcome outcome = fetchOnce(fetcher, [&stalled, &timeout](std::chrono::milliseconds attemptTimeout, AsyncCallback done) {
+            timeout = attemptTimeout;
+            stalled.hold(done);
+        });
+        failures += check(outcome.finished && !outcome.answered, "stalled request gives up");
+        failures += check(outcome.ms >= 250 && outcome.ms < 800, "stalled request gives up at the deadline, after " + std::to_string(outcome.ms) + " ms");
+        failures += check(timeout.count() > 0 && timeout.count() <= 300, "attempt timeout within the deadline");
+        failures += check(fetcher.stats().deadlineMisses == 1, "deadline miss counted");
+        stalled.release();
+    }
+
+    // Deadline bounds retries: attempts that each fail after 100 ms stop once the next one
+    // could not finish before a 250 ms deadline
+    {
+        ResilientFetcher fetcher(retryOptions(std::chrono::milliseconds(250), 10, 1.0, 100.0));
+        TimerQueue late;
+        attempts = 0;
+        Outcome outcome = fetchOnce(fetcher, [&attempts, &late](std::chrono::milliseconds, AsyncCallback done) {
+            attempts++;
+            late.schedule(std::chrono::milliseconds(100), [done] { done(nullptr); });
+        });
+        failures += check(outcome.finished && !outcome.answered, "slow failing request gives up");
+        failures += check(attempts <= 3, "deadline bounds attempts to 3, got " + std::to_string(attempts.load()));
+        failures += check(outcome.ms < 450, "slow failing request gives up near the deadline, after " + std::to_string(outcome.ms) + " ms");
+        late.shutdown();
+    }
+
+    // Hedging: once enough fast answers set the hedge delay, a stalled first attempt is
+    // answered by its hedge
+    {
+        ResilientFetcher fetcher(retryOptions(std::chrono::milliseconds(5000), 1, 1.0, 100.0, true));
+        AttemptSender fast = [](std::chrono::milliseconds, AsyncCallback done) {
+            httplib::Response res;
+            res.status = 200;
+            done(&res);
+        };
+        for (int i = 0; i < 20; i++) {
+            fetchOnce(fetcher, fast);
+        }
+        Stalled stalled;
+        std::atomic<int> sent(0);
+        Outcome outcome = fetchOnce(fetcher, [&stalled, &sent, &fast](std::chrono::milliseconds timeout, AsyncCallback done) {
+            if (sent++ == 0) {
+                stalled.hold(done);
+            }
+            else {
+                fast(timeout, done);
+            }
+        });
+        ResilientFetcher::Stats stats = fetcher.stats();
+        failures += check(outcome.answered && outcome.status == 200 && outcome.ms < 1000, "hedge answers a stalled request");
+        failures += check(stats.hedges == 1 && stats.hedgeWins == 1, "one hedge sent, and it won");
+        stalled.release();
+    }
+
+    shutdownFetching();
+    std::printf(failures == 0 ? "ok\n" : "%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// ResultApplyBenchmark.cpp
+//
+// Producer threads queue a burst of per-city results at once, the way fetch workers do when
+// many responses land together, and the main thread drains them with applyWeatherResults()
+// once per 144 Hz frame. Reports how many frames the burst was spread over, the longest a
+// frame spent applying, and how long results waited in the queue.
+// Usage: ResultApplyBenchmark [results] [producers] [cities]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "WeatherForecast.h"
+
+namespace {
+
+const std::chrono::microseconds kFrame(6944); // 144 Hz
+
+// Function to Queue count Results for the Given Cities, Round Robin
+void produce(const std::vector<CityHandle>& handles, size_t first, size_t count, uint64_t generation) {
+    for (size_t i = 0; i < count; i++) {
+        CityHandle handle = handles[(first + i) % handles.size()];
+        WeatherResult result = WeatherResult();
+        result.kind = WeatherResult::CityResult;
+        result.generation = generation;
+        result.counted = false;
+        result.city = handle;
+        result.weather.source = handle;
+        result.weather.received = true;
+        result.weather.weatherData.valid = WeatherFields::Temperature;
+        result.weather.weatherData.temperatureC = static_cast<float>(i % 40);
+        result.queued = std::chrono::steady_clock::now();
+        resultApplyStats.recordQueued();
+        weatherResults.push(std::move(result));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t resultCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    size_t producers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+    size_t cityCount = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+
+    std::vector<CityHandle> handles;
+    for (size_t i = 0; i < cityCount; i++) {
+        handles.push_back(cities.add("City " + std::to_string(i), 0.01 * i, 0.01 * i));
+    }
+
+    uint64_t generation = fetchGeneration;
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++) {
+        size_t count = resultCount / producers + (p < resultCount % producers ? 1 : 0);
+        threads.emplace_back(produce, std::cref(handles), p * cityCount / producers, count, generation);
+    }
+
+    // Frames start as soon as the burst does, as they would on the UI thread
+    size_t applied = 0;
+    int frames = 0;
+    double totalMs = 0.0;
+    auto frame = std::chrono::steady_clock::now();
+    while (applied < resultCount) {
+        auto start = std::chrono::steady_clock::now();
+        size_t taken = applyWeatherResults();
+        if (taken > 0) {
+            applied += taken;
+            frames++;
+            totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        frame += kFrame;
+        std::this_thread::sleep_until(frame);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::printf("%zu results from %zu producers onto %zu cities, %lld us budget per frame\n", resultCount, producers,
+        cityCount, static_cast<long long>(result_apply_budget.count()));
+    std::printf("  applied over %d frames, %.2f ms in total, at most %.2f ms in one frame\n", frames, totalMs,
+        resultApplyStats.maxFrameMs());
+    std::printf("  queue wait p50 %.1f ms, p99 %.1f ms\n", resultApplyStats.waits().percentile(0.50),
+        resultApplyStats.waits().percentile(0.99));
+
+    shutdownFetching();
+    return 0;
+}
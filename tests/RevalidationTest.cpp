@@ -0,0 +1,51 @@
+// RevalidationTest.cpp
+//
+// Fetches the same cities three times against the mock server on each backend: the second
+// fetch must revalidate every city with If-None-Match and keep its weather on the 304, and
+// after the server's data changes the third must download fresh bodies again.
+
+#include "FetchHarness.h"
+
+int main() {
+    const size_t cityCount = 20;
+    MockServer server;
+    api_key = "test";
+    apiRateLimiter.configure(0, 1); // No pacing against the mock server
+    batchFetchMode = false;
+    int failures = 0;
+
+    const FetchBackend backends[] = { FetchBackend::ThreadPool, FetchBackend::EventLoop };
+    const char* backendNames[] = { "thread pool", "event loop" };
+    for (int b = 0; b < 2; b++) {
+        fetchBackend = backends[b];
+        std::string backend = backendNames[b];
+        std::vector<CityHandle> all = addTestCities(cityCount);
+
+        int conditional = revalidationStats.conditional();
+        int notModified = server.notModified();
+        failures += check(runFetchCycle(all), backend + ": first cycle finishes");
+        failures += check(revalidationStats.conditional() == conditional, backend + ": first fetch is unconditional");
+        failures += check(countWithMockWeather(all) == cityCount, backend + ": first fetch fills in every city");
+        for (CityHandle handle : all) {
+            CityIndex city;
+            failures += check(cities.resolve(handle, city) && !cities.validators(city).etag.empty(), backend + ": ETag kept");
+        }
+
+        failures += check(runFetchCycle(all), backend + ": second cycle finishes");
+        failures += check(revalidationStats.conditional() - conditional == static_cast<int>(cityCount), backend + ": every city revalidated");
+        failures += check(server.notModified() - notModified == static_cast<int>(cityCount), backend + ": server answered 304 for every city");
+        failures += check(countWithMockWeather(all) == cityCount, backend + ": weather kept on 304");
+
+        server.bumpVersion();
+        notModified = server.notModified();
+        failures += check(runFetchCycle(all), backend + ": third cycle finishes");
+        failures += check(server.notModified() == notModified, backend + ": changed data is downloaded again");
+        failures += check(countWithMockWeather(all) == cityCount, backend + ": weather after the change");
+
+        std::printf("%s: %d conditional requests, %d answered 304\n", backend.c_str(), revalidationStats.conditional(), server.notModified());
+    }
+
+    shutdownFetching();
+    std::printf(failures == 0 ? "ok\n" : "%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
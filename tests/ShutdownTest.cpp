@@ -0,0 +1,133 @@
+// ShutdownTest.cpp
+//
+// Shuts each layer of the fetch path down while work is still pending and checks that every
+// pending job, ticket and request hears back: the worker pool runs dropped handlers, the task
+// scheduler runs queued tasks, the rate limiter releases queued jobs, the async client fails
+// in-flight requests, and shutting the app's fetching down returns a geocoding lookup and a
+// fetch cycle stuck on a slow server.
+
+#include <future>
+#include <memory>
+#include "FetchHarness.h"
+
+namespace {
+
+const std::chrono::milliseconds kSlowServer(3000); // Longer than any shutdown may take
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main() {
+    int failures = 0;
+
+    // Worker pool: jobs queued behind a running one, or submitted after shutdown, are dropped
+    // and run their dropped handlers instead
+    {
+        WorkerPool pool(1);
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        std::atomic<int> ran(0);
+        std::atomic<int> dropped(0);
+        pool.submit([released, &ran] { released.wait(); ran++; });
+        for (int i = 0; i < 4; i++) {
+            pool.submit([&ran] { ran++; }, false, [&dropped] { dropped++; });
+        }
+        std::thread stopper([&pool] { pool.shutdown(); });
+        while (dropped < 4) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Dropped before the running job is joined
+        }
+        release.set_value();
+        stopper.join();
+        pool.submit([&ran] { ran++; }, false, [&dropped] { dropped++; });
+        failures += check(ran == 1, "worker pool: only the running job ran");
+        failures += check(dropped == 5, "worker pool: queued and late jobs ran their dropped handlers");
+    }
+
+    // Task scheduler: tasks queued behind a running one still run by the time shutdown returns,
+    // and a task submitted after shutdown runs before submit returns
+    {
+        TaskScheduler scheduler(1);
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        std::atomic<int> ran(0);
+        scheduler.submit([released, &ran] { released.wait(); ran++; });
+        for (int i = 0; i < 4; i++) {
+            scheduler.submit([&ran] { ran++; });
+        }
+        std::thread stopper([&scheduler] { scheduler.shutdown(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Usually stopping before the running task ends
+        release.set_value();
+        stopper.join();
+        failures += check(ran == 5, "task scheduler: queued tasks ran by shutdown, got " + std::to_string(ran.load()));
+        scheduler.submit([&ran] { ran++; });
+        failures += check(ran == 6, "task scheduler: task submitted after shutdown ran");
+    }
+
+    // Rate limiter: jobs waiting for a token, or scheduled after shutdown, are released
+    {
+        RateLimiter limiter(1, 1); // One token, then one a minute
+        std::atomic<int> ran(0);
+        for (int i = 0; i < 5; i++) {
+            limiter.schedule(RequestPriority::Background, [&ran] { ran++; });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        failures += check(ran == 1, "rate limiter: one job granted before shutdown");
+        limiter.shutdown();
+        failures += check(ran == 5, "rate limiter: queued jobs released by shutdown");
+        limiter.schedule(RequestPriority::Interactive, [&ran] { ran++; });
+        failures += check(ran == 6, "rate limiter: job scheduled after shutdown released");
+        failures += check(!limiter.acquire(RequestPriority::Interactive), "rate limiter: acquire after shutdown fails");
+    }
+
+    MockServer server;
+    server.setDelay(kSlowServer);
+
+    // Async client: requests on the wire and waiting for a connection fail on shutdown
+    {
+        AsyncHttpClient client(std::string("http://") + WEATHERFORECAST_TEST_HOST + ":" + std::to_string(WEATHERFORECAST_TEST_PORT),
+            AsyncTransport::Epoll, 1, 4);
+        std::atomic<int> failed(0);
+        for (int i = 0; i < 10; i++) {
+            client.get("/data/2.5/weather?lat=1&lon=2", httplib::Headers(), [&failed](const httplib::Response* res) {
+                if (!res) {
+                    failed++;
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto start = std::chrono::steady_clock::now();
+        client.shutdown();
+        failures += check(failed == 10, "async client: every pending request failed, got " + std::to_string(failed.load()));
+        failures += check(msSince(start) < 1000, "async client: shutdown does not wait for the server");
+        failures += check(client.inFlight() == 0, "async client: nothing left in flight");
+    }
+
+    // The app: a geocoding lookup and a fetch cycle waiting on the slow server both return
+    {
+        api_key = "test";
+        apiRateLimiter.configure(0, 1);
+        fetchBackend = FetchBackend::ThreadPool;
+        std::vector<CityHandle> all = addTestCities(40);
+        fetchWeatherDataForCities(all);
+        auto lookup = std::make_shared<std::promise<bool>>();
+        std::future<bool> looked = lookup->get_future();
+        std::thread([lookup] {
+            double lon, lat;
+            lookup->set_value(validateCity("Slow Town", lon, lat));
+        }).detach();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        auto start = std::chrono::steady_clock::now();
+        shutdownFetching();
+        failures += check(msSince(start) < 2000, "app: shutdown does not wait for the server, took " + std::to_string(msSince(start)) + " ms");
+        failures += check(looked.wait_for(std::chrono::seconds(2)) == std::future_status::ready && !looked.get(),
+            "app: pending lookup returns not found");
+        applyWeatherResults();
+        failures += check(countWithMockWeather(all) == 0, "app: no weather from the stopped cycle");
+    }
+
+    std::printf(failures == 0 ? "ok\n" : "%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
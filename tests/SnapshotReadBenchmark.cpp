@@ -0,0 +1,181 @@
+// SnapshotReadBenchmark.cpp
+//
+// Times what a frame pays to read every city's numeric weather, the read path a per-city
+// seqlock would speed up. Snapshots are read inside an RCU read guard: first with no writer,
+// then while writer threads publish new ones, and against a global mutex over plain records
+// with the same writers. The app itself has a single writer, the UI thread, since results
+// are applied there; the writer threads stand in for the fetch workers that used to store.
+// Usage: SnapshotReadBenchmark [cities] [writers]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CityStore.h"
+
+namespace {
+
+const std::chrono::milliseconds kDuration(1000);
+const std::chrono::microseconds kFrame(6944); // 144 Hz
+
+WeatherSnapshot snapshotFor(int value) {
+    WeatherSnapshot weather = WeatherSnapshot();
+    weather.valid = WeatherFields::Temperature | WeatherFields::Humidity | WeatherFields::WindSpeed;
+    weather.temperatureC = static_cast<float>(value);
+    weather.humidity = value;
+    weather.windSpeed = 1.0f;
+    return weather;
+}
+
+double percentile(std::vector<double> samples, double fraction) {
+    std::sort(samples.begin(), samples.end());
+    return samples[std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()))];
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Function to Read Every City's Numbers Frame after Frame for kDuration; returns ns per city read
+double readFrames(CityStore& store, double& checksum) {
+    unsigned long long reads = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + kDuration;
+    while (std::chrono::steady_clock::now() < end) {
+        RcuDomain::ReadGuard guard(store.rcu());
+        for (CityIndex i = 0; i < store.slots(); i++) {
+            const WeatherSnapshot* weather = store.weather(i);
+            if (weather) {
+                checksum += weather->temperatureC + weather->humidity + weather->windSpeed;
+            }
+        }
+        reads += store.slots();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / reads;
+}
+
+struct Contention {
+    std::vector<double> frameMs;
+    unsigned long long writes;
+    double checksum;
+};
+
+// Function to Run writers Threads Storing Weather While a 144 Hz Reader Scans Every City;
+// store(city, value) writes one city, scan() reads them all and returns a checksum
+template <typename Store, typename Scan>
+Contention contend(size_t count, size_t writers, Store store, Scan scan) {
+    Contention result = Contention();
+    std::atomic<bool> done(false);
+    std::atomic<unsigned long long> writes(0);
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < writers; w++) {
+        threads.emplace_back([&, w] {
+            unsigned long long written = 0;
+            for (size_t i = w; !done; i += writers) {
+                store(static_cast<CityIndex>(i % count), static_cast<int>(i));
+                written++;
+            }
+            writes += written;
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto frame = start;
+    while (std::chrono::steady_clock::now() - start < kDuration) {
+        auto scanned = std::chrono::steady_clock::now();
+        result.checksum += scan();
+        result.frameMs.push_back(msSince(scanned));
+        frame += kFrame;
+        std::this_thread::sleep_until(frame);
+    }
+    done = true;
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    result.writes = writes;
+    return result;
+}
+
+void report(const char* name, const Contention& contention) {
+    std::printf("  %-28s scan p50 %7.3f ms  p99 %7.3f ms  %6.1fM writes/s\n", name, percentile(contention.frameMs, 0.50),
+        percentile(contention.frameMs, 0.99), contention.writes / 1e6 / (kDuration.count() / 1000.0));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t writers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 32;
+    CityStore store;
+    for (size_t i = 0; i < count; i++) {
+        CityHandle city = store.add("City " + std::to_string(i), 0.0, 0.0);
+        store.setWeather(city.slot, snapshotFor(static_cast<int>(i)));
+    }
+
+    double checksum = 0.0;
+    double quiet = readFrames(store, checksum);
+
+    // Snapshots are only published on the UI thread, so here the reader runs on another
+    // thread, as a render thread would, while this one keeps publishing.
+    std::atomic<bool> done(false);
+    double contended = 0.0;
+    std::thread reader([&store, &checksum, &contended, &done] {
+        contended = readFrames(store, checksum);
+        done = true;
+    });
+    unsigned long long published = 0;
+    while (!done) {
+        store.setWeather(static_cast<CityIndex>(published % count), snapshotFor(static_cast<int>(published)));
+        if (++published % 1024 == 0) {
+            store.rcu().collect();
+        }
+    }
+    reader.join();
+
+    std::printf("%zu cities\n", count);
+    std::printf("  read, no writer:             %6.2f ns/city\n", quiet);
+    std::printf("  read while publishing:       %6.2f ns/city (%llu snapshots published)\n", contended, published);
+
+    // Writers publish one at a time, as setWeather() requires; the reader never waits for them
+    std::mutex publishMutex;
+    Contention snapshots = contend(count, writers, [&store, &publishMutex](CityIndex city, int value) {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        store.setWeather(city, snapshotFor(value));
+    }, [&store] {
+        double sum = 0.0;
+        RcuDomain::ReadGuard guard(store.rcu());
+        for (CityIndex i = 0; i < store.slots(); i++) {
+            const WeatherSnapshot* weather = store.weather(i);
+            if (weather) {
+                sum += weather->temperatureC + weather->humidity + weather->windSpeed;
+            }
+        }
+        return sum;
+    });
+
+    // Every writer and the reader share one mutex, as weatherDataMutex did
+    std::mutex recordsMutex;
+    std::vector<WeatherSnapshot> records(count, snapshotFor(0));
+    Contention mutex = contend(count, writers, [&records, &recordsMutex](CityIndex city, int value) {
+        WeatherSnapshot weather = snapshotFor(value);
+        std::lock_guard<std::mutex> lock(recordsMutex);
+        records[city] = weather;
+    }, [&records, &recordsMutex] {
+        double sum = 0.0;
+        std::lock_guard<std::mutex> lock(recordsMutex);
+        for (const WeatherSnapshot& weather : records) {
+            sum += weather.temperatureC + weather.humidity + weather.windSpeed;
+        }
+        return sum;
+    });
+
+    std::printf("%zu writers, reader at 144 Hz\n", writers);
+    report("snapshots:", snapshots);
+    report("global mutex:", mutex);
+    std::printf("(checksum %.0f)\n", checksum + snapshots.checksum + mutex.checksum);
+    return 0;
+}
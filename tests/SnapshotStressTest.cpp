@@ -0,0 +1,122 @@
+// SnapshotStressTest.cpp
+//
+// Reader threads walk the city store inside RCU read guards while the "UI thread" publishes
+// new weather snapshots, removes and re-adds cities and grows the store past a column chunk.
+// Every snapshot a reader sees must be one that was published whole. Build with
+// -DCMAKE_CXX_FLAGS=-fsanitize=thread (or address) to check the publication and reclamation.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CityStore.h"
+
+namespace {
+
+const size_t kInitialCities = 4000;
+const size_t kMaxCities = CityColumn<int>::kChunkSize + 1000; // Grows into a second chunk
+const size_t kReaders = 4;
+const std::chrono::milliseconds kDuration(1500);
+
+// A snapshot whose fields all encode the same value, so a torn or freed one shows
+WeatherSnapshot snapshotFor(int value) {
+    WeatherSnapshot weather = WeatherSnapshot();
+    weather.valid = WeatherFields::Temperature | WeatherFields::Humidity | WeatherFields::Description;
+    weather.temperatureC = static_cast<float>(value);
+    weather.humidity = value;
+    weather.observedAt = value;
+    std::snprintf(weather.description, sizeof(weather.description), "value %d", value);
+    return weather;
+}
+
+bool consistent(const WeatherSnapshot& weather) {
+    char expected[sizeof(weather.description)];
+    std::snprintf(expected, sizeof(expected), "value %d", weather.humidity);
+    return weather.temperatureC == static_cast<float>(weather.humidity) && weather.observedAt == weather.humidity &&
+        std::strcmp(weather.description, expected) == 0;
+}
+
+} // namespace
+
+int main() {
+    CityStore store;
+    for (size_t i = 0; i < kInitialCities; i++) {
+        CityHandle city = store.add("City " + std::to_string(i), 0.0, 0.0);
+        store.setWeather(city.slot, snapshotFor(static_cast<int>(i)));
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<unsigned long long> reads(0);
+    std::atomic<unsigned long long> inconsistent(0);
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < kReaders; r++) {
+        readers.emplace_back([&store, &stop, &reads, &inconsistent] {
+            unsigned long long seen = 0;
+            unsigned long long torn = 0;
+            while (!stop) {
+                RcuDomain::ReadGuard guard(store.rcu());
+                size_t slots = store.slots();
+                for (CityIndex i = 0; i < slots; i++) {
+                    CityIndex slot;
+                    if (!store.resolve(store.handle(i), slot)) {
+                        continue; // Removed, or added after slots() was read
+                    }
+                    const WeatherSnapshot* weather = store.weather(slot);
+                    if (weather) {
+                        seen++;
+                        torn += consistent(*weather) ? 0 : 1;
+                    }
+                }
+            }
+            reads += seen;
+            inconsistent += torn;
+        });
+    }
+
+    std::mt19937 random(42);
+    unsigned long long published = 0;
+    unsigned long long replaced = 0;
+    int value = static_cast<int>(kInitialCities);
+    auto end = std::chrono::steady_clock::now() + kDuration;
+    while (std::chrono::steady_clock::now() < end) {
+        for (int step = 0; step < 64; step++) {
+            CityIndex city = random() % store.slots();
+            if (!store.alive(city)) {
+                continue;
+            }
+            if (step % 8 == 0) {
+                store.remove(store.handle(city));
+                city = store.add("City " + std::to_string(value), 0.0, 0.0).slot;
+                replaced++;
+            }
+            store.setWeather(city, snapshotFor(value++));
+            published++;
+        }
+        for (int grown = 0; grown < 16 && store.slots() < kMaxCities; grown++) {
+            CityHandle city = store.add("City " + std::to_string(value), 0.0, 0.0);
+            store.setWeather(city.slot, snapshotFor(value++));
+        }
+        store.rcu().collect();
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    store.rcu().collect();
+    store.rcu().collect();
+    store.rcu().collect();
+
+    RcuDomain::Stats stats = store.rcu().stats();
+    std::printf("%llu snapshots published, %llu cities replaced, %zu slots; %llu reads, %llu inconsistent; "
+        "%llu retired, %llu reclaimed, %zu pending\n",
+        published, replaced, store.slots(), reads.load(), inconsistent.load(),
+        static_cast<unsigned long long>(stats.retired), static_cast<unsigned long long>(stats.reclaimed), stats.pending);
+    bool ok = inconsistent == 0 && reads > 0 && store.slots() > CityColumn<int>::kChunkSize && stats.pending == 0 &&
+        stats.reclaimed == stats.retired;
+    std::printf(ok ? "ok\n" : "FAIL\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+// TaskSchedulerBenchmark.cpp
+//
+// Runs the parse → derive pipeline over many weather bodies on the work-stealing
+// TaskScheduler and on the shared-queue WorkerPool, for a range of worker counts. Bodies are
+// submitted from two producer threads, as the I/O threads would, and each parse submits its
+// derive step from the worker it runs on. Also times what an I/O thread spends per group
+// response when it parses inline versus hands the body to the scheduler.
+// Usage: TaskSchedulerBenchmark [bodies]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <json.hpp>
+#include "TaskScheduler.h"
+#include "WeatherFields.h"
+#include "WorkerPool.h"
+
+namespace {
+
+std::atomic<long long> checksum(0);
+
+std::string weatherBody(int id) {
+    nlohmann::json body = {
+        { "id", id },
+        { "dt", 1700000000 },
+        { "name", "City " + std::to_string(id) },
+        { "weather", { { { "description", "clear sky" } } } },
+        { "main", { { "temp", 293.15 }, { "humidity", 40 } } },
+        { "wind", { { "speed", 3.5 } } },
+        { "sys", { { "sunrise", 1700000000 }, { "sunset", 1700040000 } } },
+        { "coord", { { "lat", 1.0 }, { "lon", 2.0 } } }
+    };
+    return body.dump();
+}
+
+// Parses a body in three pieces, as it would stream in, then submits the derive step
+void parseThenDerive(const std::string& body, const std::function<void(std::function<void()>)>& submit) {
+    StreamedWeather stream;
+    size_t third = body.size() / 3;
+    stream.feed(body.data(), third);
+    stream.feed(body.data() + third, third);
+    stream.feed(body.data() + 2 * third, body.size() - 2 * third);
+    stream.finish();
+    std::shared_ptr<WeatherFields> fields = std::make_shared<WeatherFields>(stream.extractor().fields());
+    submit([fields] { checksum += fields->snapshot().humidity; });
+}
+
+// Function to Run the Pipeline Over Every Body on an Executor; returns the elapsed milliseconds
+template <typename Executor>
+double runPipeline(Executor& executor, const std::vector<std::string>& bodies) {
+    auto start = std::chrono::steady_clock::now();
+    std::function<void(std::function<void()>)> submit = [&executor](std::function<void()> task) { executor.submit(std::move(task)); };
+    std::thread producers[2];
+    for (size_t p = 0; p < 2; p++) {
+        producers[p] = std::thread([&executor, &bodies, &submit, p] {
+            for (size_t i = p; i < bodies.size(); i += 2) {
+                executor.submit([&bodies, &submit, i] { parseThenDerive(bodies[i], submit); });
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    executor.waitIdle();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 40000;
+    std::vector<std::string> bodies;
+    for (size_t i = 0; i < count; i++) {
+        bodies.push_back(weatherBody(static_cast<int>(i)));
+    }
+
+    std::printf("%zu bodies parsed and derived (%u hardware threads)\n", count, std::thread::hardware_concurrency());
+    for (size_t workers : { 1, 2, 4, 8 }) {
+        double scheduled;
+        TaskScheduler::Stats stats;
+        {
+            TaskScheduler scheduler(workers);
+            scheduled = runPipeline(scheduler, bodies);
+            stats = scheduler.stats();
+        }
+        double pooled;
+        {
+            WorkerPool pool(workers);
+            pooled = runPipeline(pool, bodies);
+        }
+        std::printf("  %zu workers: task scheduler %8.1f ms (%llu tasks, %llu stolen), worker pool %8.1f ms\n", workers, scheduled,
+            static_cast<unsigned long long>(stats.executed), static_cast<unsigned long long>(stats.stolen), pooled);
+    }
+
+    const size_t groupCount = 400;
+    std::vector<std::string> groups;
+    for (size_t g = 0; g < groupCount; g++) {
+        nlohmann::json list = nlohmann::json::array();
+        for (int k = 0; k < 20; k++) {
+            list.push_back(nlohmann::json::parse(weatherBody(static_cast<int>(g * 20 + k))));
+        }
+        groups.push_back(nlohmann::json({ { "cnt", 20 }, { "list", list } }).dump());
+    }
+    auto parseGroup = [](const std::string& body) {
+        StreamedWeather stream;
+        stream.feed(body.data(), body.size());
+        stream.finish();
+        for (const WeatherFields& fields : stream.extractor().list()) {
+            checksum += fields.snapshot().humidity;
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& group : groups) {
+        parseGroup(group);
+    }
+    double inlineUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / groupCount;
+    TaskScheduler scheduler(0);
+    start = std::chrono::steady_clock::now();
+    for (const std::string& group : groups) {
+        std::shared_ptr<std::string> body = std::make_shared<std::string>(group);
+        scheduler.submit([body, &parseGroup] { parseGroup(*body); });
+    }
+    double handOffUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / groupCount;
+    scheduler.waitIdle();
+    std::printf("I/O thread time per group response of %zu bytes: parse inline %.1f us, hand off %.2f us\n",
+        groups[0].size(), inlineUs, handOffUs);
+    std::printf("(checksum %lld)\n", checksum.load());
+    return 0;
+}